@@ -76,4 +76,9 @@ SECTIONS
     .ramVecs    : > SRAM2_BASE, type=NOLOAD
 
     .log_data   :   > LOG_DATA, type = COPY
+
+    /* Event trace ring (trace.c). NOLOAD keeps the startup code from zeroing
+     * it, so the events before a watchdog reset can be read after it.
+     */
+    .trace_data :   > SRAM, type = NOLOAD
 }
@@ -0,0 +1,63 @@
+/*
+ *  ======== cycles.h ========
+ *  Cortex-M4 DWT cycle counter, used to measure what the tick functions cost.
+ *  The counter runs at the CPU clock (80 MHz on the CC3220S) and wraps about
+ *  every 53 seconds, so only ever subtract two nearby readings.
+ *
+ *  Host builds (HOST_BUILD) count nanoseconds of the monotonic clock instead,
+ *  or of a simulated clock that the host tool advances when hostClockSimulated
+ *  is set.
+ */
+#ifndef CYCLES_H_
+#define CYCLES_H_
+
+#include <stdint.h>
+
+#if defined(HOST_BUILD)
+
+#include <stdbool.h>
+#include <time.h>
+
+#define CYCLES_PER_US 1000
+
+// Defined in host_drivers.c
+extern bool hostClockSimulated;
+extern volatile uint32_t hostClockNs;
+
+static inline void cyclesInit(void)
+{
+}
+
+static inline uint32_t cyclesNow(void)
+{
+    struct timespec ts;
+    if (hostClockSimulated) {
+        return hostClockNs;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+#else
+
+#define CYCLES_PER_US 80
+
+#define DWT_CTRL    (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004)
+#define CORE_DEMCR  (*(volatile uint32_t *)0xE000EDFC)
+
+static inline void cyclesInit(void)
+{
+    CORE_DEMCR |= (1UL << 24);      // TRCENA: enable the DWT block
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= 1UL;                // CYCCNTENA: start counting
+}
+
+static inline uint32_t cyclesNow(void)
+{
+    return DWT_CYCCNT;
+}
+
+#endif /* HOST_BUILD */
+
+#endif /* CYCLES_H_ */
@@ -0,0 +1,59 @@
+/*
+ *  ======== fmt.c ========
+ */
+#include <stdint.h>
+
+#include "fmt.h"
+
+char *fmtStr(char *p, const char *s)
+{
+    while (*s) {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+char *fmtUint(char *p, uint32_t value, uint8_t width)
+{
+    char digits[10];
+    uint8_t n = 0;
+
+    // Digits come out least significant first
+    do {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+
+    while (width > n) {
+        *p++ = '0';
+        --width;
+    }
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+char *fmtInt(char *p, int32_t value, uint8_t width)
+{
+    if (value < 0) {
+        *p++ = '-';
+        return fmtUint(p, 0 - (uint32_t)value, width ? width - 1 : 0);
+    }
+    return fmtUint(p, (uint32_t)value, width);
+}
+
+char *fmtHex(char *p, uint32_t value, uint8_t width)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    int8_t shift = 28;
+
+    // Skip leading zeros outside the width but always print at least one digit
+    while (shift > 0 && shift >= width * 4 && ((value >> shift) & 0xF) == 0) {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        *p++ = hexDigits[(value >> shift) & 0xF];
+    }
+    return p;
+}
@@ -0,0 +1,34 @@
+/*
+ *  ======== fmt.h ========
+ *  Allocation-free formatting for the console output, used in place of snprintf.
+ *  Shared by the thermostat and the trace export in trace.c.
+ *
+ *  A line is built by chaining calls that each append one field and return the
+ *  new end of the buffer, so the layout is fixed at compile time and nothing is
+ *  parsed at run time:
+ *
+ *      char *p = output;
+ *      p = fmtChar(p, '<');
+ *      p = fmtInt(p, temperature, 2);      // same as "%02d"
+ *      DISPLAY(p - output)
+ *
+ *  The caller makes sure the buffer is large enough; an int32_t field needs at
+ *  most 11 characters.
+ */
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <stdint.h>
+
+static inline char *fmtChar(char *p, char c)
+{
+    *p++ = c;
+    return p;
+}
+
+char *fmtStr(char *p, const char *s);
+char *fmtUint(char *p, uint32_t value, uint8_t width);  // "%0<width>u"
+char *fmtInt(char *p, int32_t value, uint8_t width);    // "%0<width>d", the sign counts toward width
+char *fmtHex(char *p, uint32_t value, uint8_t width);   // "%0<width>x", width at most 8
+
+#endif /* FMT_H_ */
@@ -0,0 +1,93 @@
+/*
+ *  ======== hal.c ========
+ */
+#include "hal.h"
+
+/*
+ *  ======== GPIO ========
+ */
+void halGpioInit(void)
+{
+    GPIO_init();
+}
+
+// Push-pull output, starts low
+void halOutputInit(uint_least8_t index)
+{
+    GPIO_setConfig(index, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
+}
+
+// LaunchPad button: pulled up, interrupt on the press
+void halButtonInit(uint_least8_t index, GPIO_CallbackFxn callback)
+{
+    GPIO_setConfig(index, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+    GPIO_setCallback(index, callback);
+    GPIO_enableInt(index);
+}
+
+/*
+ *  ======== UART ========
+ */
+UART_Handle halUartOpen(uint_least8_t index, UART_Callback readCallback)
+{
+    UART_Params uartParams;
+
+    UART_init();
+    UART_Params_init(&uartParams);
+    uartParams.writeDataMode = UART_DATA_BINARY;
+    uartParams.readDataMode = UART_DATA_BINARY;
+    uartParams.readReturnMode = UART_RETURN_FULL;
+    if (readCallback != NULL) {
+        uartParams.readMode = UART_MODE_CALLBACK;
+        uartParams.readCallback = readCallback;
+    }
+    uartParams.baudRate = 115200;
+
+    return UART_open(index, &uartParams);
+}
+
+/*
+ *  ======== UART2 ========
+ */
+UART2_Handle halUart2Open(uint_least8_t index, UART2_Mode readMode)
+{
+    UART2_Params uartParams;
+
+    UART2_Params_init(&uartParams);
+    uartParams.baudRate = 115200;
+    uartParams.readMode = readMode;
+    uartParams.readReturnMode = UART2_ReadReturnMode_PARTIAL;
+
+    return UART2_open(index, &uartParams);
+}
+
+/*
+ *  ======== I2C ========
+ */
+I2C_Handle halI2COpen(uint_least8_t index, I2C_BitRate bitRate)
+{
+    I2C_Params i2cParams;
+
+    I2C_init();
+    I2C_Params_init(&i2cParams);
+    i2cParams.bitRate = bitRate;
+
+    return I2C_open(index, &i2cParams);
+}
+
+/*
+ *  ======== Timer ========
+ */
+Timer_Handle halTimerOpen(uint_least8_t index, uint32_t periodUs, Timer_Mode mode, Timer_CallBackFxn callback)
+{
+    Timer_Params params;
+
+    Timer_init();
+    Timer_Params_init(&params);
+    params.period = periodUs;
+    params.periodUnits = Timer_PERIOD_US;
+    params.timerMode = mode;
+    params.timerCallback = callback;
+
+    return Timer_open(index, &params);
+}
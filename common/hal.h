@@ -0,0 +1,142 @@
+/*
+ *  ======== hal.h ========
+ *  Driver layer shared by both LaunchPad projects.
+ *
+ *  The open helpers hold the parameter boilerplate each project used to repeat
+ *  and return NULL on failure like the drivers do. The calls on the hot paths
+ *  are static inline, so they cost the same as calling the driver directly.
+ *  Everything goes through the TI driver API, which is resolved at link time:
+ *  against the SimpleLink SDK libraries on the board, against
+ *  host/host_drivers.c in host builds.
+ *
+ *  UART writes and I2C transfers log their start and end to the event trace
+ *  (trace.h), so bus time shows up on the scheduler timeline.
+ */
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/UART.h>
+#include <ti/drivers/UART2.h>
+#include <ti/drivers/dpl/ClockP.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "trace.h"
+
+/*
+ *  ======== GPIO ========
+ */
+void halGpioInit(void);
+void halOutputInit(uint_least8_t index);
+void halButtonInit(uint_least8_t index, GPIO_CallbackFxn callback);
+
+static inline void halPinWrite(uint_least8_t index, bool on)
+{
+    GPIO_write(index, on ? CONFIG_GPIO_LED_ON : CONFIG_GPIO_LED_OFF);
+}
+
+/*
+ *  ======== UART ========
+ *  The thermostat console: binary, 115200 baud. Reads are in callback mode
+ *  when readCallback is given, blocking otherwise.
+ */
+UART_Handle halUartOpen(uint_least8_t index, UART_Callback readCallback);
+
+static inline void halUartWrite(UART_Handle handle, const void *buffer, size_t size)
+{
+    traceEvent(TRACE_UartStart, 0, (uint16_t)size);
+    UART_write(handle, buffer, size);
+    traceEvent(TRACE_UartEnd, 0, 0);
+}
+
+// For interrupt context, where a blocking write can't be used
+static inline void halUartWritePolling(UART_Handle handle, const void *buffer, size_t size)
+{
+    traceEvent(TRACE_UartStart, 0, (uint16_t)size);
+    UART_writePolling(handle, buffer, size);
+    traceEvent(TRACE_UartEnd, 0, 0);
+}
+
+// In callback mode this only arms the read; the callback gets the bytes
+static inline void halUartRead(UART_Handle handle, void *buffer, size_t size)
+{
+    UART_read(handle, buffer, size);
+}
+
+/*
+ *  ======== UART2 ========
+ *  The uart2echo console: 115200 baud, blocking writes. A blocking read returns as
+ *  soon as it has something rather than waiting to fill the buffer.
+ */
+UART2_Handle halUart2Open(uint_least8_t index, UART2_Mode readMode);
+
+// Both return the UART2 driver's status. In nonblocking mode a read with nothing to
+// take returns UART2_STATUS_EAGAIN.
+static inline int_fast16_t halUart2Read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead)
+{
+    return UART2_read(handle, buffer, size, bytesRead);
+}
+
+// A blocking read that gives up after timeoutMs with UART2_STATUS_ETIMEOUT and whatever had come in
+static inline int_fast16_t halUart2ReadTimeout(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead,
+                                               uint32_t timeoutMs)
+{
+    return UART2_readTimeout(handle, buffer, size, bytesRead, timeoutMs * 1000 / ClockP_getSystemTickPeriod());
+}
+
+static inline int_fast16_t halUart2Write(UART2_Handle handle, const void *buffer, size_t size, size_t *bytesWritten)
+{
+    int_fast16_t status;
+
+    traceEvent(TRACE_UartStart, 0, (uint16_t)size);
+    status = UART2_write(handle, buffer, size, bytesWritten);
+    traceEvent(TRACE_UartEnd, 0, 0);
+    return status;
+}
+
+/*
+ *  ======== I2C ========
+ */
+I2C_Handle halI2COpen(uint_least8_t index, I2C_BitRate bitRate);
+
+static inline void halI2CClose(I2C_Handle handle)
+{
+    I2C_close(handle);
+}
+
+static inline bool halI2CTransfer(I2C_Handle handle, I2C_Transaction *transaction)
+{
+    bool ok;
+
+    traceEvent(TRACE_I2CStart, (uint8_t)transaction->slaveAddress, 0);
+    ok = I2C_transfer(handle, transaction);
+    traceEvent(TRACE_I2CEnd, (uint8_t)transaction->slaveAddress, ok);
+    return ok;
+}
+
+/*
+ *  ======== Timer ========
+ *  Periods are in microseconds. halTimerOpen() does not start the timer.
+ */
+Timer_Handle halTimerOpen(uint_least8_t index, uint32_t periodUs, Timer_Mode mode, Timer_CallBackFxn callback);
+
+static inline bool halTimerSetPeriod(Timer_Handle handle, uint32_t periodUs)
+{
+    return Timer_setPeriod(handle, Timer_PERIOD_US, periodUs) == Timer_STATUS_SUCCESS;
+}
+
+static inline bool halTimerStart(Timer_Handle handle)
+{
+    return Timer_start(handle) != Timer_STATUS_ERROR;
+}
+
+#endif /* HAL_H_ */
@@ -33,7 +33,11 @@
 
 /*
  *  ======== main_nortos.c ========
+ *  Shared by both projects. The thermostat's FreeRTOS build configuration
+ *  (THERMOSTAT_FREERTOS) uses its main_freertos.c instead.
  */
+#if !defined(THERMOSTAT_FREERTOS)
+
 #include <stdint.h>
 #include <stddef.h>
 
@@ -58,3 +62,5 @@ int main(void)
 
     while (1) {}
 }
+
+#endif /* THERMOSTAT_FREERTOS */
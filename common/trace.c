@@ -0,0 +1,73 @@
+/*
+ *  ======== trace.c ========
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cycles.h"
+#include "fmt.h"
+#include "hal.h"
+#include "trace.h"
+
+// Left alone by the C startup code so that it outlives a reset
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_SECTION(traceBuffer, ".trace_data")
+#pragma NOINIT(traceBuffer)
+#endif
+traceBuf traceBuffer;
+volatile bool traceFrozen = false;
+
+// Call once at boot, after cyclesInit(). A ring left by the previous run is
+// kept if its header says it came from this build; anything else is power-on
+// garbage and is cleared.
+void traceInit(void)
+{
+    if (traceBuffer.magic != TRACE_MAGIC || traceBuffer.size != TRACE_RING_SIZE
+        || traceBuffer.cyclesPerUs != CYCLES_PER_US) {
+        memset(&traceBuffer, 0, sizeof(traceBuffer));
+        traceBuffer.magic = TRACE_MAGIC;
+        traceBuffer.size = TRACE_RING_SIZE;
+        traceBuffer.cyclesPerUs = CYCLES_PER_US;
+    }
+    ++traceBuffer.boots;
+    traceFrozen = false;
+    traceEvent(TRACE_Boot, 0, (uint16_t)traceBuffer.boots);
+}
+
+// Writes the ring oldest first, one "@T,<16 hex digits>" line per record (time,
+// type, id and arg, as in traceRecord), between "@T,begin,<records>,<cycles per us>"
+// and "@T,end". Logging stops while it runs, which takes a couple of seconds at
+// 115200 baud, so it is only meant to be triggered by hand.
+void traceExport(UART_Handle uart)
+{
+    char line[32];
+    char *p;
+    uint32_t end;
+    uint32_t i;
+
+    traceFrozen = true;
+    end = traceBuffer.count;
+    i = (end > TRACE_RING_SIZE) ? end - TRACE_RING_SIZE : 0;
+
+    p = fmtStr(line, "@T,begin,");
+    p = fmtUint(p, end - i, 0);
+    p = fmtChar(p, ',');
+    p = fmtUint(p, traceBuffer.cyclesPerUs, 0);
+    p = fmtStr(p, "\r\n");
+    halUartWrite(uart, line, p - line);
+
+    for (; i < end; ++i) {
+        const traceRecord *r = &traceBuffer.ring[i & (TRACE_RING_SIZE - 1)];
+        p = fmtStr(line, "@T,");
+        p = fmtHex(p, r->time, 8);
+        p = fmtHex(p, r->type, 2);
+        p = fmtHex(p, r->id, 2);
+        p = fmtHex(p, r->arg, 4);
+        p = fmtStr(p, "\r\n");
+        halUartWrite(uart, line, p - line);
+    }
+
+    halUartWrite(uart, "@T,end\r\n", 8);
+    traceFrozen = false;
+}
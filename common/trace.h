@@ -0,0 +1,96 @@
+/*
+ *  ======== trace.h ========
+ *  Binary event trace for scheduler timelines, shared by both projects.
+ *
+ *  Task begin and end, interrupt entry and the start and end of every I2C
+ *  transfer and UART write (from the hal.h calls) go into a RAM ring as 8 byte
+ *  records stamped with the cycle counter. Logging one is a few stores with
+ *  interrupts masked, about twenty cycles on the M4, so the trace stays on in
+ *  normal builds; build with TRACE_ENABLE 0 to compile the calls out.
+ *
+ *  The ring is placed in its own .trace_data section (see cc32xxs_nortos.cmd),
+ *  which is not zeroed at startup. After a watchdog reset the events that led
+ *  up to it are still there: traceInit() keeps a ring whose header is intact
+ *  and marks the reboot in it. Read it out with the debugger (save the memory
+ *  of traceBuffer to a binary file) or over the console with traceExport(),
+ *  and turn either into a Chrome trace with host/trace2json.c.
+ */
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/UART.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "cycles.h"
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+// Number of records kept. Must be a power of two. A thermostat pass logs a
+// dozen or so, so this holds the last few seconds.
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 1024
+#endif
+
+#define TRACE_MAGIC 0x54524345      // "TRCE"
+
+enum TRACE_Types {
+    TRACE_Boot,         // traceInit(); the cycle counter starts again from here
+    TRACE_TaskBegin,    // id is the task, see enum TASK_Ids
+    TRACE_TaskEnd,
+    TRACE_Isr,          // id is one of TRACE_Irqs
+    TRACE_I2CStart,     // id is the slave address
+    TRACE_I2CEnd,       // arg is 1 if the transfer went through
+    TRACE_UartStart,    // arg is the length
+    TRACE_UartEnd
+};
+
+enum TRACE_Irqs { TRACE_IrqTimer, TRACE_IrqButton0, TRACE_IrqButton1, TRACE_IrqUartRx, TRACE_IrqWatchdog };
+
+typedef struct traceRecord {
+    uint32_t time;      // cyclesNow() when the event was logged
+    uint8_t type;       // TRACE_Types
+    uint8_t id;
+    uint16_t arg;
+} traceRecord;
+
+// The layout is read back by host/trace2json.c, so keep the two in step
+typedef struct traceBuf {
+    uint32_t magic;
+    uint32_t count;         // Total records logged, across resets
+    uint16_t size;          // TRACE_RING_SIZE
+    uint16_t cyclesPerUs;   // CYCLES_PER_US of the build that wrote it
+    uint32_t boots;
+    traceRecord ring[TRACE_RING_SIZE];
+} traceBuf;
+
+extern traceBuf traceBuffer;
+extern volatile bool traceFrozen;   // Set while traceExport() reads the ring out
+
+static inline void traceEvent(uint8_t type, uint8_t id, uint16_t arg)
+{
+#if TRACE_ENABLE
+    uintptr_t key;
+    traceRecord *r;
+
+    if (traceFrozen) {
+        return;
+    }
+    key = HwiP_disable();
+    r = &traceBuffer.ring[traceBuffer.count++ & (TRACE_RING_SIZE - 1)];
+    r->time = cyclesNow();
+    r->type = type;
+    r->id = id;
+    r->arg = arg;
+    HwiP_restore(key);
+#endif
+}
+
+void traceInit(void);
+void traceExport(UART_Handle uart);
+
+#endif /* TRACE_H_ */
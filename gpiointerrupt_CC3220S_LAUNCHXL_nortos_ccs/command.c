@@ -0,0 +1,175 @@
+/*
+ *  ======== command.c ========
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "command.h"
+#include "control.h"
+#include "fmt.h"
+#include "gpiointerrupt.h"
+#include "hal.h"
+#include "program.h"
+#include "trace.h"
+
+static char rxByte;
+static char line[CMD_LINE_MAX];
+static uint8_t lineLength = 0;
+static volatile bool lineReady = false;
+
+// Kicks off the first one byte read. Every later read is started from the callback.
+void commandStart(UART_Handle uart)
+{
+    halUartRead(uart, &rxByte, 1);
+}
+
+// Runs in interrupt context. Bytes that come in while a line is waiting to be run are dropped.
+void commandRxCallback(UART_Handle handle, void *buf, size_t count)
+{
+    traceEvent(TRACE_Isr, TRACE_IrqUartRx, (uint16_t)count);
+    if (count == 1 && !lineReady) {
+        if (rxByte == '\r' || rxByte == '\n') {
+            if (lineLength > 0) {
+                line[lineLength] = '\0';
+                lineReady = true;
+            }
+        } else if (lineLength < CMD_LINE_MAX - 1) {
+            line[lineLength++] = rxByte;
+        }
+    }
+    halUartRead(handle, &rxByte, 1);
+}
+
+// Skips spaces then reads a decimal number. Returns NULL if there isn't one, or if it
+// doesn't fit in 32 bits, rather than letting it wrap to some small value.
+static const char *parseUint(const char *s, unsigned long *value)
+{
+    unsigned long v = 0;
+    unsigned long digit;
+
+    while (*s == ' ') {
+        ++s;
+    }
+    if (*s < '0' || *s > '9') {
+        return NULL;
+    }
+    while (*s >= '0' && *s <= '9') {
+        digit = (unsigned long)(*s++ - '0');
+        if (v > (UINT32_MAX - digit) / 10) {
+            return NULL;
+        }
+        v = v * 10 + digit;
+    }
+    *value = v;
+    return s;
+}
+
+// Matches a command word at the start of the line and returns what follows it
+static const char *matchWord(const char *s, const char *word)
+{
+    size_t n = strlen(word);
+
+    if (strncmp(s, word, n) != 0 || (s[n] != ' ' && s[n] != '\0')) {
+        return NULL;
+    }
+    return s + n;
+}
+
+static void listTasks(void)
+{
+    char out[48];
+    char *p;
+    unsigned char i;
+
+    for (i = 0; i < numTasks; ++i) {
+        p = fmtStr(out, "#task ");
+        p = fmtUint(p, i, 0);
+        p = fmtStr(p, " period=");
+        p = fmtUint(p, tasks[i].period, 0);
+        p = fmtStr(p, " enabled=");
+        p = fmtUint(p, tasks[i].enabled, 0);
+        p = fmtStr(p, "\r\n");
+        halUartWrite(uart, out, p - out);
+    }
+    p = fmtStr(out, "#task tick=");
+    p = fmtUint(p, timerPeriod, 0);
+    p = fmtStr(p, "\r\n");
+    halUartWrite(uart, out, p - out);
+}
+
+static bool runCommand(const char *s)
+{
+    const char *args;
+    unsigned long id;
+    unsigned long ms;
+    unsigned long day, hour, minute, temp;
+
+    if (matchWord(s, "tasks") != NULL) {
+        listTasks();
+        return true;
+    }
+    if ((args = matchWord(s, "period")) != NULL) {
+        if ((args = parseUint(args, &id)) == NULL || parseUint(args, &ms) == NULL || id >= numTasks) {
+            return false;
+        }
+        return taskSetPeriod(id, ms);
+    }
+    if ((args = matchWord(s, "phase")) != NULL) {
+        if ((args = parseUint(args, &id)) == NULL || parseUint(args, &ms) == NULL || id >= numTasks) {
+            return false;
+        }
+        return taskSetPhase(id, ms);
+    }
+    if ((args = matchWord(s, "enable")) != NULL) {
+        return parseUint(args, &id) != NULL && id < numTasks && taskEnable(id, true);
+    }
+    if ((args = matchWord(s, "disable")) != NULL) {
+        return parseUint(args, &id) != NULL && id < numTasks && taskEnable(id, false);
+    }
+    if ((args = matchWord(s, "ctrl")) != NULL) {
+        if ((args = parseUint(args, &id)) == NULL || parseUint(args, &ms) == NULL
+            || id >= NUM_ZONES || ms >= CTRL_NUM_MODES) {
+            return false;
+        }
+        controlSetMode(id, ms);
+        return true;
+    }
+    if ((args = matchWord(s, "clock")) != NULL) {
+        if ((args = parseUint(args, &day)) == NULL || (args = parseUint(args, &hour)) == NULL
+            || parseUint(args, &minute) == NULL || day > DAY_Sun || hour > 23 || minute > 59) {
+            return false;
+        }
+        programSetClock((day * 24 + hour) * 60 + minute);
+        return true;
+    }
+    if ((args = matchWord(s, "prog")) != NULL) {
+        if (matchWord(args, " clear") != NULL) {
+            programClear();
+            return true;
+        }
+        if ((args = parseUint(args, &day)) == NULL || (args = parseUint(args, &hour)) == NULL
+            || (args = parseUint(args, &minute)) == NULL || parseUint(args, &temp) == NULL
+            || day > DAY_Sun || hour > 23 || minute > 59 || temp > PROGRAM_TEMP_MAX) {
+            return false;
+        }
+        return programAdd(day, hour, minute, temp);
+    }
+    return false;
+}
+
+// Called from the main loop. Nothing happens until a whole line has come in.
+void commandPoll(void)
+{
+    if (!lineReady) {
+        return;
+    }
+    if (runCommand(line)) {
+        halUartWrite(uart, "ok\r\n", 4);
+    } else {
+        halUartWrite(uart, "err\r\n", 5);
+    }
+    lineLength = 0;
+    lineReady = false;
+}
@@ -0,0 +1,36 @@
+/*
+ *  ======== command.h ========
+ *  Console commands for retuning the task scheduler and editing the setpoint
+ *  program without reflashing.
+ *
+ *  The console UART is opened in callback read mode and commandRxCallback()
+ *  collects one line at a time. commandPoll() runs a finished line from the
+ *  main loop and answers "ok" or "err".
+ *
+ *    period <task> <ms>        Change how often a task runs, up to TASK_PERIOD_MAX
+ *    phase <task> <ms>         Run a task <ms> from now, then every period
+ *    enable <task>             Resume a task
+ *    disable <task>            Stop running a task
+ *    tasks                     List the tasks and the base tick
+ *    ctrl <zone> <mode>        Pick a zone's control law, see control.h
+ *    clock <d> <hh> <mm>       Set the time of week and start the program
+ *    prog <d> <hh> <mm> <c>    Add or change a program transition
+ *    prog clear                Empty the program
+ *
+ *  Tasks are numbered as in enum TASK_Ids. Days run from 0 for Monday, see program.h.
+ */
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stddef.h>
+
+#include <ti/drivers/UART.h>
+
+// Longest command line kept. Extra characters are dropped.
+#define CMD_LINE_MAX 32
+
+void commandStart(UART_Handle uart);
+void commandRxCallback(UART_Handle handle, void *buf, size_t count);
+void commandPoll(void);
+
+#endif /* COMMAND_H_ */
@@ -0,0 +1,109 @@
+/*
+ *  ======== control.c ========
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "control.h"
+#include "filter.h"
+#include "timerwheel.h"
+#include "zones.h"
+
+// Largest integral the I term can use; beyond it the output is saturated anyway
+#define INTEGRAL_LIMIT  ((int32_t)1000 * 60 * (1 << TEMP_FRACTION_BITS) / (PID_KI > 0 ? PID_KI : 1))
+
+controlTable control;
+
+static wheelTimer pwmWindow[NUM_ZONES];
+static wheelTimer pwmEdge[NUM_ZONES];
+
+static void pwmEdgeDue(wheelTimer *timer)
+{
+    zonesSetHeater((uint8_t)timer->arg, HTR_Off);
+}
+
+// Start of a PWM window. Takes the latest PID output, so a new output waits for the next window.
+static void pwmWindowDue(wheelTimer *timer)
+{
+    uint8_t z = (uint8_t)timer->arg;
+    uint32_t onMs = (uint32_t)control.output[z] * PWM_WINDOW_MS / 1000;
+
+    if (onMs < PWM_MIN_MS || zonesHalted) {
+        onMs = 0;
+    } else if (onMs > PWM_WINDOW_MS - PWM_MIN_MS) {
+        onMs = PWM_WINDOW_MS;
+    }
+
+    zonesSetHeater(z, (onMs > 0) ? HTR_On : HTR_Off);
+    if (onMs > 0 && onMs < PWM_WINDOW_MS) {
+        wheelStart(&pwmEdge[z], onMs, 0, pwmEdgeDue, z);
+    }
+}
+
+// Sets every zone to CONTROL_MODE. The wheel must have been set up (wheelInit()) first.
+void controlInit(void)
+{
+    uint8_t z;
+
+    memset(&control, 0, sizeof(control));
+    memset(pwmWindow, 0, sizeof(pwmWindow));
+    memset(pwmEdge, 0, sizeof(pwmEdge));
+    for (z = 0; z < NUM_ZONES; ++z) {
+        control.deadband[z] = CONTROL_DEADBAND;
+        controlSetMode(z, CONTROL_MODE);
+    }
+}
+
+void controlSetMode(uint8_t z, uint8_t mode)
+{
+    control.mode[z] = mode;
+    control.output[z] = 0;
+    control.integral[z] = 0;
+    control.primed[z] = 0;
+
+    wheelCancel(&pwmEdge[z]);
+    if (mode == CTRL_PID) {
+        if (!wheelActive(&pwmWindow[z])) {
+            wheelStart(&pwmWindow[z], PWM_WINDOW_MS, PWM_WINDOW_MS, pwmWindowDue, z);
+        }
+    } else {
+        wheelCancel(&pwmWindow[z]);
+    }
+}
+
+// One PID step for zone z, elapsedMs after the last. Returns the heater power in permille.
+// The derivative works on the reading rather than the error so a setpoint change doesn't kick it.
+uint16_t controlPid(uint8_t z, uint32_t elapsedMs)
+{
+    int32_t temp = zones.filteredTemp[z];
+    int32_t error = ((int32_t)zones.setTempCelsius[z] << TEMP_FRACTION_BITS) - temp;
+    int32_t integral = control.integral[z] + error * (int32_t)elapsedMs / 1000;
+    int32_t rate = 0;
+    int32_t out;
+
+    if (integral > INTEGRAL_LIMIT) {
+        integral = INTEGRAL_LIMIT;
+    } else if (integral < -INTEGRAL_LIMIT) {
+        integral = -INTEGRAL_LIMIT;
+    }
+    if (control.primed[z] && elapsedMs > 0) {
+        rate = (temp - control.lastTemp[z]) * 1000 / (int32_t)elapsedMs;
+    }
+    control.lastTemp[z] = (int16_t)temp;
+    control.primed[z] = 1;
+
+    out = (PID_KP * error + PID_KI * integral / 60 - PID_KD * rate) / (1 << TEMP_FRACTION_BITS);
+
+    // Only integrate while the output isn't pinned in the direction the error pushes it
+    if (!((out >= 1000 && error > 0) || (out <= 0 && error < 0))) {
+        control.integral[z] = integral;
+    }
+
+    if (out < 0) {
+        out = 0;
+    } else if (out > 1000) {
+        out = 1000;
+    }
+    control.output[z] = (uint16_t)out;
+    return (uint16_t)out;
+}
@@ -0,0 +1,75 @@
+/*
+ *  ======== control.h ========
+ *  Control laws for the zone heaters.
+ *
+ *  CTRL_Hysteresis is the original on/off thermostat on whole degrees with
+ *  zones.hysteresis either side of the setpoint. CTRL_Deadband switches on the
+ *  filtered reading instead: on below the setpoint by half of control.deadband,
+ *  off above it by the same. CTRL_PID works out a heater power from 0 to 1000
+ *  permille with integer arithmetic only, and a time-proportioning PWM turns
+ *  that into on and off time within each PWM_WINDOW_MS.
+ *
+ *  The PWM runs on two timing wheel timers per zone (timerwheel.h): one starts
+ *  each window and switches the heater on, the other switches it off part way
+ *  through. The heater pin is written twice a window at most, whatever the
+ *  control pass does. Mains heaters and their relays want windows of minutes,
+ *  not a hardware PWM carrier, so the window is long on purpose; the heater's
+ *  own warm-up smooths the pulses out.
+ *
+ *  The gains and the window were tuned against the room model in
+ *  host/plant.c.
+ *
+ *  A PID pass is a fixed handful of multiplies and divides, so its cost is the
+ *  same every time; see the cyc/zone figure in the stats report and the
+ *  TickFct_CheckTemp/pid benchmark.
+ */
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include <stdint.h>
+
+#include "filter.h"
+#include "zones.h"
+
+enum CTRL_Modes { CTRL_Hysteresis, CTRL_Deadband, CTRL_PID, CTRL_NUM_MODES };
+
+#ifndef CONTROL_MODE
+#define CONTROL_MODE CTRL_Hysteresis
+#endif
+
+#define CONTROL_DEADBAND    (1 << TEMP_FRACTION_BITS)   // 1 C wide, in 1/128 C
+
+// PID gains. The error is in C, the output in permille of the PWM window.
+#ifndef PID_KP
+#define PID_KP  400     // Per C of error
+#endif
+#ifndef PID_KI
+#define PID_KI  12      // Per C of error held for a minute
+#endif
+#ifndef PID_KD
+#define PID_KD  0       // Per C/s the reading is rising
+#endif
+
+#ifndef PWM_WINDOW_MS
+#define PWM_WINDOW_MS   120000
+#endif
+#ifndef PWM_MIN_MS
+#define PWM_MIN_MS      5000    // Shorter on or off times are dropped to spare the relay
+#endif
+
+typedef struct controlTable {
+    uint8_t mode[NUM_ZONES];            // CTRL_Modes
+    int16_t deadband[NUM_ZONES];        // 1/128 C
+    uint16_t output[NUM_ZONES];         // PID heater power, permille
+    int32_t integral[NUM_ZONES];        // Error over time, 1/128 C x s
+    int16_t lastTemp[NUM_ZONES];        // filteredTemp on the last PID pass
+    uint8_t primed[NUM_ZONES];          // lastTemp holds a reading
+} controlTable;
+
+extern controlTable control;
+
+void controlInit(void);
+void controlSetMode(uint8_t z, uint8_t mode);
+uint16_t controlPid(uint8_t z, uint32_t elapsedMs);
+
+#endif /* CONTROL_H_ */
@@ -0,0 +1,85 @@
+/*
+ *  ======== cpuload.c ========
+ */
+#include <stdint.h>
+
+#include "cpuload.h"
+#include "cycles.h"
+
+uint16_t cpuLoad1s = 0;
+uint16_t cpuLoad10s = 0;
+uint16_t cpuLoad60s = 0;
+uint16_t cpuLoadPeak = 0;
+
+// The second being measured. Its length comes from the cycle counter, so ticks
+// that were missed because a pass overran its period still count as time.
+static uint32_t windowStart;
+static uint64_t windowBusy;
+static unsigned long windowMs;
+
+// Ring of one second samples with running sums for the two averages
+static uint16_t history[LOAD_HISTORY];
+static uint8_t historyNext = 0;
+static uint8_t historyCount = 0;
+static uint32_t sum10 = 0;
+static uint32_t sum60 = 0;
+
+void cpuLoadInit(void)
+{
+    windowStart = cyclesNow();
+    windowBusy = 0;
+    windowMs = 0;
+}
+
+static void addSample(uint16_t load)
+{
+    // The sample 60 seconds back is overwritten and the one 10 seconds back drops out of sum10
+    if (historyCount >= LOAD_HISTORY) {
+        sum60 -= history[historyNext];
+    }
+    if (historyCount >= 10) {
+        sum10 -= history[(historyNext + LOAD_HISTORY - 10) % LOAD_HISTORY];
+    }
+    history[historyNext] = load;
+    sum10 += load;
+    sum60 += load;
+    historyNext = (historyNext + 1) % LOAD_HISTORY;
+    if (historyCount < LOAD_HISTORY) {
+        ++historyCount;
+    }
+
+    cpuLoad1s = load;
+    cpuLoad10s = sum10 / (historyCount < 10 ? historyCount : 10);
+    cpuLoad60s = sum60 / historyCount;
+    if (load > cpuLoadPeak) {
+        cpuLoadPeak = load;
+    }
+}
+
+// Called by the main loop after each serviced tick with the cycles it spent on it
+void cpuLoadTick(uint32_t busyCycles, unsigned long tickMs)
+{
+    uint32_t now;
+    uint32_t elapsed;
+    uint64_t load;
+
+    windowBusy += busyCycles;
+    windowMs += tickMs;
+    if (windowMs < 1000) {
+        return;
+    }
+
+    now = cyclesNow();
+    elapsed = now - windowStart;
+    load = (elapsed != 0) ? windowBusy * 1000 / elapsed : 0;
+    addSample(load > 1000 ? 1000 : (uint16_t)load);
+
+    windowStart = now;
+    windowBusy = 0;
+    windowMs = 0;
+}
+
+void cpuLoadPeakReset(void)
+{
+    cpuLoadPeak = 0;
+}
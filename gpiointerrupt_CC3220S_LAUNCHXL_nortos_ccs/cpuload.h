@@ -0,0 +1,26 @@
+/*
+ *  ======== cpuload.h ========
+ *  CPU load of the NoRTOS main loop.
+ *
+ *  The main loop spins on timerFlag. The cycles from seeing the flag to clearing
+ *  it again are busy time and everything else is idle time. Interrupt handlers
+ *  that fire while the loop is spinning count as idle. Loads are in permille.
+ */
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+#include <stdint.h>
+
+// One second samples kept for the longer averages
+#define LOAD_HISTORY 60
+
+extern uint16_t cpuLoad1s;      // Last full second
+extern uint16_t cpuLoad10s;     // Mean of the last 10 seconds
+extern uint16_t cpuLoad60s;     // Mean of the last 60 seconds
+extern uint16_t cpuLoadPeak;    // Busiest second since cpuLoadPeakReset()
+
+void cpuLoadInit(void);
+void cpuLoadTick(uint32_t busyCycles, unsigned long tickMs);
+void cpuLoadPeakReset(void);
+
+#endif /* CPULOAD_H_ */
@@ -0,0 +1,107 @@
+/*
+ *  ======== duty.c ========
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "duty.h"
+#include "filter.h"
+#include "zones.h"
+
+dutyTable duty;
+
+void dutyInit(void)
+{
+    uint8_t z;
+
+    memset(&duty, 0, sizeof(duty));
+    for (z = 0; z < NUM_ZONES; ++z) {
+        duty.settleSet[z] = zones.setTempCelsius[z];
+        duty.settleDir[z] = 1;
+    }
+}
+
+void dutyAdvance(uint32_t ms)
+{
+    duty.nowMs += ms;
+}
+
+// Closes the period that just ended. Called by zonesControlPass() when zone z's heater switches.
+void dutyTransition(uint8_t z, uint8_t state)
+{
+    uint64_t length = duty.nowMs - duty.lastChangeMs[z];
+
+    duty.lastChangeMs[z] = duty.nowMs;
+    if (state == HTR_On) {
+        duty.offMs[z] += length;
+        ++duty.offCount[z];
+        // The off period is over, so its peak is final
+        if (duty.onCount[z] > 0) {
+            if (duty.peak[z] > duty.overshootMax[z]) {
+                duty.overshootMax[z] = duty.peak[z];
+            }
+            duty.overshootSum[z] += duty.peak[z];
+            ++duty.overshootCount[z];
+        }
+    } else {
+        duty.onMs[z] += length;
+        ++duty.onCount[z];
+        duty.peak[z] = 0;
+    }
+}
+
+// Tracks overshoot and time to setpoint. Called by zonesControlPass() for every zone on every pass.
+void dutySample(uint8_t z)
+{
+    int16_t set = zones.setTempCelsius[z];
+    int16_t above = zones.filteredTemp[z] - (set << TEMP_FRACTION_BITS);
+
+    if (zones.heaterState[z] == HTR_Off && above > duty.peak[z]) {
+        duty.peak[z] = above;
+    }
+
+    if (set != duty.settleSet[z]) {
+        duty.settleSet[z] = set;
+        duty.settleDir[z] = (set > zones.currentTempCelsius[z]) ? 1 : -1;
+        duty.settleStartMs[z] = duty.nowMs;
+    }
+    if ((duty.settleDir[z] > 0 && zones.currentTempCelsius[z] >= set)
+        || (duty.settleDir[z] < 0 && zones.currentTempCelsius[z] <= set)) {
+        duty.settleMs[z] = (uint32_t)(duty.nowMs - duty.settleStartMs[z]);
+        duty.settleDir[z] = 0;
+    }
+}
+
+// Total on time, including an on period still in progress
+uint64_t dutyOnMs(uint8_t z)
+{
+    uint64_t on = duty.onMs[z];
+
+    if (zones.heaterState[z] == HTR_On) {
+        on += duty.nowMs - duty.lastChangeMs[z];
+    }
+    return on;
+}
+
+// Share of the time since power up the heater was on
+uint16_t dutyPermille(uint8_t z)
+{
+    if (duty.nowMs == 0) {
+        return 0;
+    }
+    return (uint16_t)(dutyOnMs(z) * 1000 / duty.nowMs);
+}
+
+// Heater switch-ons per hour since power up
+uint32_t dutyCyclesPerHour(uint8_t z)
+{
+    if (duty.nowMs == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)duty.offCount[z] * 3600000UL / duty.nowMs);
+}
+
+uint32_t dutyWattHours(uint8_t z)
+{
+    return (uint32_t)(dutyOnMs(z) * DUTY_HEATER_WATTS / 3600000UL);
+}
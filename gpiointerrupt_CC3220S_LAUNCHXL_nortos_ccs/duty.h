@@ -0,0 +1,58 @@
+/*
+ *  ======== duty.h ========
+ *  Heater duty cycle and energy, kept per zone.
+ *
+ *  The accumulators are only touched when a heater switches (dutyTransition())
+ *  and once per control pass (dutySample()), both O(1), so the figures cost
+ *  nothing to keep up to date. On and off periods are counted once they close;
+ *  the one in progress is added in when a report asks for it. The clock and
+ *  the time totals are 64 bit, since a millisecond count in 32 bits wraps
+ *  after 49.7 days and a thermostat runs for years.
+ *
+ *  Overshoot is how far the zone rises above its setpoint after its heater
+ *  switches off, taken at the peak of each off period. Time to setpoint runs
+ *  from each setpoint change (and from power up) to the first reading that
+ *  reaches the new setpoint.
+ */
+#ifndef DUTY_H_
+#define DUTY_H_
+
+#include <stdint.h>
+
+#include "zones.h"
+
+// Rated power of one heater, for the energy figure
+#ifndef DUTY_HEATER_WATTS
+#define DUTY_HEATER_WATTS 1500
+#endif
+
+typedef struct dutyTable {
+    uint64_t nowMs;                         // Advanced by every control pass
+    uint64_t lastChangeMs[NUM_ZONES];       // When the heater last switched
+    uint64_t onMs[NUM_ZONES];               // Closed on periods
+    uint64_t offMs[NUM_ZONES];              // Closed off periods
+    uint32_t onCount[NUM_ZONES];
+    uint32_t offCount[NUM_ZONES];
+    int16_t peak[NUM_ZONES];                // Highest reading above the setpoint this off period, 1/128 C
+    int16_t overshootMax[NUM_ZONES];        // 1/128 C
+    uint32_t overshootSum[NUM_ZONES];       // 1/128 C, over overshootCount off periods
+    uint32_t overshootCount[NUM_ZONES];
+    int16_t settleSet[NUM_ZONES];           // Setpoint being approached
+    int8_t settleDir[NUM_ZONES];            // 1 heating up to it, -1 cooling down, 0 reached
+    uint64_t settleStartMs[NUM_ZONES];
+    uint32_t settleMs[NUM_ZONES];           // Time to setpoint after the last change that was reached
+} dutyTable;
+
+extern dutyTable duty;
+
+void dutyInit(void);
+void dutyAdvance(uint32_t ms);
+void dutyTransition(uint8_t z, uint8_t state);
+void dutySample(uint8_t z);
+
+uint64_t dutyOnMs(uint8_t z);
+uint16_t dutyPermille(uint8_t z);
+uint32_t dutyCyclesPerHour(uint8_t z);
+uint32_t dutyWattHours(uint8_t z);
+
+#endif /* DUTY_H_ */
@@ -0,0 +1,61 @@
+/*
+ *  ======== filter.c ========
+ */
+#include <stdint.h>
+
+#include "filter.h"
+#include "zones.h"
+
+static struct {
+    int16_t window[NUM_ZONES][FILTER_MEDIAN];
+    uint8_t next[NUM_ZONES];            // Oldest slot in window, overwritten next
+    int32_t ema[NUM_ZONES];             // Average scaled up by 2^FILTER_EMA_SHIFT
+} filterState;
+
+// Starts a zone's filter over from a single sample, so a fresh sensor doesn't
+// ramp up from zero
+void filterReset(uint8_t zone, int16_t sample)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILTER_MEDIAN; ++i) {
+        filterState.window[zone][i] = sample;
+    }
+    filterState.next[zone] = 0;
+    filterState.ema[zone] = (int32_t)sample << FILTER_EMA_SHIFT;
+}
+
+static int16_t median(const int16_t *window)
+{
+#if FILTER_MEDIAN == 1
+    return window[0];
+#else
+    int16_t sorted[FILTER_MEDIAN];
+    uint8_t i, j;
+
+    // Insertion sort of at most five values
+    for (i = 0; i < FILTER_MEDIAN; ++i) {
+        int16_t v = window[i];
+        for (j = i; j > 0 && sorted[j - 1] > v; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    return sorted[FILTER_MEDIAN / 2];
+#endif
+}
+
+// Adds a sample and returns the filtered value, both in sensor units
+int16_t filterUpdate(uint8_t zone, int16_t sample)
+{
+    int32_t m;
+
+    filterState.window[zone][filterState.next[zone]] = sample;
+    filterState.next[zone] = (filterState.next[zone] + 1) % FILTER_MEDIAN;
+    m = median(filterState.window[zone]);
+
+    // ema += m - ema / 2^shift, so ema / 2^shift moves 1/2^shift of the way to m
+    filterState.ema[zone] += m - (filterState.ema[zone] >> FILTER_EMA_SHIFT);
+
+    return (int16_t)(filterState.ema[zone] >> FILTER_EMA_SHIFT);
+}
@@ -0,0 +1,46 @@
+/*
+ *  ======== filter.h ========
+ *  Integer-only smoothing of the temperature samples between TickFct_SetTemp
+ *  and the heater control pass.
+ *
+ *  Samples are in sensor units of 1/128 C. Each zone's samples go through a
+ *  median of the last FILTER_MEDIAN samples, which throws away single-sample
+ *  spikes, and then an exponential moving average with weight
+ *  1/2^FILTER_EMA_SHIFT. Both stages cost a fixed number of operations per
+ *  sample. FILTER_OVERSAMPLE back-to-back reads are averaged into each sample
+ *  before it gets here (see TickFct_SetTemp); only useful with a sensor whose
+ *  conversion time is shorter than an I2C read.
+ */
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+
+#include "zones.h"
+
+#ifndef FILTER_OVERSAMPLE
+#define FILTER_OVERSAMPLE   1
+#endif
+
+// 1 (off), 3 or 5 samples
+#ifndef FILTER_MEDIAN
+#define FILTER_MEDIAN       3
+#endif
+
+// 0 turns the average off
+#ifndef FILTER_EMA_SHIFT
+#define FILTER_EMA_SHIFT    2
+#endif
+
+#define TEMP_FRACTION_BITS  7           // Sensor units are 1/128 C
+
+// Nearest whole degree of a value in sensor units
+static inline int16_t tempToCelsius(int16_t value)
+{
+    return (int16_t)((value + (1 << (TEMP_FRACTION_BITS - 1))) >> TEMP_FRACTION_BITS);
+}
+
+void filterReset(uint8_t zone, int16_t sample);
+int16_t filterUpdate(uint8_t zone, int16_t sample);
+
+#endif /* FILTER_H_ */
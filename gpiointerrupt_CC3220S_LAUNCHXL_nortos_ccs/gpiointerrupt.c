@@ -35,7 +35,6 @@
  */
 #include <stdint.h>
 #include <stddef.h>
-#include <stdio.h>
 
 /* Driver Header files */
 #include <ti/drivers/GPIO.h>
@@ -51,23 +50,46 @@
 #include <ti/drivers/I2C.h>
 #include <ti/drivers/UART.h>
 
+#include "command.h"
+#include "control.h"
+#include "cpuload.h"
+#include "cycles.h"
+#include "duty.h"
+#include "filter.h"
+#include "fmt.h"
+#include "gpiointerrupt.h"
+#include "hal.h"
+#include "latency.h"
+#include "program.h"
+#include "pt.h"
+#include "i2cbusclear.h"
+#include "recorder.h"
+#include "settings.h"
+#include "supervisor.h"
+#include "threads.h"
+#include "timerwheel.h"
+#include "trace.h"
+#include "zones.h"
+
 // Global shared variables
-int16_t setTempCelsius = 22;
-int16_t currentTempCelsius;
 unsigned long timerPeriod = 100;
 unsigned long totalTimeElapsed = 0;
-char heaterOn = 0;          // bit
 char upBtnPressed = 0;      // bit
 char downBtnPressed = 0;    // bit
-char timerFlag = 0;         // bit
+volatile char timerFlag = 0;    // bit, set by the timer interrupt
 
 /*
  *  ======== UART Driver Stuff ========
  */
-#define DISPLAY(x) UART_write(uart, &output, x);
+// Lines are built in output[] with the fmt.h helpers and DISPLAY() is given the length.
+// Fixed text goes straight out of flash with DISPLAY_STR() without being copied.
+#define DISPLAY(x) halUartWrite(uart, &output, x);
+#define DISPLAY_STR(s) halUartWrite(uart, s, sizeof(s) - 1);
 
-// UART Global Variables
-char output[64];
+// UART Global Variables. Big enough for any line built with fmt.h: the longest, the second
+// #stats heat line, is about 110 characters with every figure at full width. Per task figures
+// (ten digits each) go on lines of their own so this doesn't grow with NUM_TASKS.
+char output[128];
 int bytesToSend;
 
 // Driver Handles - Global variables
@@ -75,18 +97,8 @@ UART_Handle uart;
 
 void initUART(void)
 {
-    UART_Params uartParams;
-    // Init the driver
-    UART_init();
-    // Configure the driver
-    UART_Params_init(&uartParams);
-    uartParams.writeDataMode = UART_DATA_BINARY;
-    uartParams.readDataMode = UART_DATA_BINARY;
-    uartParams.readReturnMode = UART_RETURN_FULL;
-    uartParams.baudRate = 115200;
-
-    // Open the driver
-    uart = UART_open(CONFIG_UART_0, &uartParams);
+    // Console commands come in a byte at a time through the read callback, see command.c
+    uart = halUartOpen(CONFIG_UART_0, commandRxCallback);
 
     if (uart == NULL) {
         /* UART_open() failed */
@@ -98,25 +110,11 @@ void initUART(void)
 
 // Set up a task type to track each tasks's relevant information
 // Code adapted from Emerging Systems Architectures and Technologies, ZyBooks ISBN: 979-8-203-05560-6
-const unsigned char numTasks = 5;
-
-typedef struct task {
-    int state;
-    unsigned long period;
-    unsigned long elapsedTime;
-    int (*TickFct)(int);        // Pointer to the tasks processing function
-} task;
-
-task tasks[5];
-
-enum BTN_States { BTN_Off, BTN_On };
-enum HTR_States { HTR_Off, HTR_On };
+// The task type and tick function declarations are in gpiointerrupt.h
+const unsigned char numTasks = NUM_TASKS;
 
-// State machine tick function declarations
-int TickFct_CheckUpBtn(int state);
-int TickFct_CheckDownBtn(int state);
-int TickFct_CheckTemp(int state);
-int TickFct_Output(int state);
+task tasks[NUM_TASKS];
+taskTiming taskStats;
 
 /*
  *  ======== I2C Driver Stuff ========
@@ -134,35 +132,52 @@ sensors[3] = {
     { 0x41, 0x0001, "006" }
 };
 
+#define NUM_SENSORS 3
+
 uint8_t txBuffer[1];
 uint8_t rxBuffer[2];
 I2C_Transaction i2cTransaction;
 
+// Indexes into sensors[] of the sensors that answered during initI2C()
+uint8_t detectedSensors[NUM_SENSORS];
+uint8_t numDetectedSensors = 0;
+
+#define I2C_BIT_RATE I2C_400kHz
+
 // Driver Handles - Global variables
 I2C_Handle i2c;
 
+// Transfer and failure counters, reported in the stats output
+unsigned long i2cReads = 0;         // Sensor reads attempted
+unsigned long i2cFailures = 0;      // Transfers that failed
+unsigned long i2cRecoveries = 0;    // Reads that succeeded after a bus clear and driver re-open
+unsigned long i2cSkippedReads = 0;  // Reads skipped while backing off a failed sensor
+
+// Back-off for sensors that keep failing. After the n-th failure in a row the zone's sensor
+// is skipped for 2^(n-1) visits of TickFct_SetTemp, up to I2C_MAX_BACKOFF.
+#define I2C_MAX_BACKOFF 16
+
+static struct {
+    uint8_t failures[NUM_ZONES];    // Consecutive failed reads
+    uint8_t skip[NUM_ZONES];        // Visits left to skip before the next attempt
+} sensorBackoff;
+
 // Make sure you call initUART() before calling this function.
 void initI2C(void)
 {
     int8_t i, found;
-    I2C_Params i2cParams;
-    DISPLAY(snprintf(output, 64, "Initializing I2C Driver - "));
+    char *p;
+    DISPLAY_STR("Initializing I2C Driver - ")
 
-    // Init the driver
-    I2C_init();
-    // Configure the driver
-    I2C_Params_init(&i2cParams);
-    i2cParams.bitRate = I2C_400kHz;
-    // Open the driver
-    i2c = I2C_open(CONFIG_I2C_0, &i2cParams);
+    i2c = halI2COpen(CONFIG_I2C_0, I2C_BIT_RATE);
 
     if (i2c == NULL)
     {
-        DISPLAY(snprintf(output, 64, "Failed\n\r"));
+        DISPLAY_STR("Failed\n\r")
         while (1);
     }
 
-    DISPLAY(snprintf(output, 32, "Passed\n\r"));
+    DISPLAY_STR("Passed\n\r")
 
     // Boards were shipped with different sensors.
     // Welcome to the world of embedded systems.
@@ -174,62 +189,183 @@ void initI2C(void)
     i2cTransaction.readBuf = rxBuffer;
     i2cTransaction.readCount = 0;
 
+    // Every zone needs its own sensor, so scan all of the addresses rather
+    // than stopping at the first one that answers
     found = false;
-    for (i=0; i<3; ++i)
+    for (i=0; i<NUM_SENSORS; ++i)
     {
         i2cTransaction.slaveAddress = sensors[i].address;
         txBuffer[0] = sensors[i].resultReg;
-        DISPLAY(snprintf(output, 64, "Is this %s? ", sensors[i].id));
-        if (I2C_transfer(i2c, &i2cTransaction))
+        p = fmtStr(output, "Is this ");
+        p = fmtStr(p, sensors[i].id);
+        p = fmtStr(p, "? ");
+        DISPLAY(p - output)
+        if (halI2CTransfer(i2c, &i2cTransaction))
         {
-            DISPLAY(snprintf(output, 64, "Found\n\r"));
+            DISPLAY_STR("Found\n\r")
+            p = fmtStr(output, "Detected TMP");
+            p = fmtStr(p, sensors[i].id);
+            p = fmtStr(p, " I2C address: ");
+            p = fmtHex(p, i2cTransaction.slaveAddress, 0);
+            p = fmtStr(p, "\n\r");
+            DISPLAY(p - output)
+            detectedSensors[numDetectedSensors++] = i;
             found = true;
-            break;
+            continue;
         }
-        DISPLAY(snprintf(output, 64, "No\n\r"));
+        DISPLAY_STR("No\n\r")
     }
 
-    if(found)
+    if(!found)
     {
-        DISPLAY(snprintf(output, 64, "Detected TMP%s I2C address: %x\n\r", sensors[i].id, i2cTransaction.slaveAddress));
+        DISPLAY_STR("Temperature sensor not found, contact professor\n\r")
     }
-    else
+}
+
+// One read of a sensor's result register into rxBuffer
+static bool transferTemp(uint8_t sensor)
+{
+    i2cTransaction.slaveAddress = sensors[sensor].address;
+    txBuffer[0] = sensors[sensor].resultReg;
+    i2cTransaction.readCount = 2;
+    i2cReads++;
+    // A recovery that couldn't reopen the driver leaves no handle; the read just fails
+    if (i2c == NULL)
     {
-        DISPLAY(snprintf(output, 64, "Temperature sensor not found, contact professor\n\r"));
+        i2cTransaction.status = I2C_STATUS_ERROR;
     }
+    else if (halI2CTransfer(i2c, &i2cTransaction))
+    {
+        recorderLog(REC_Temp, sensor, (rxBuffer[0] << 8) | (rxBuffer[1]));
+        return true;
+    }
+
+    recorderLog(REC_TempFail, sensor, i2cTransaction.status);
+    i2cFailures++;
+    return false;
 }
 
-int16_t readTemp(void)
+// A slave that lost sync part way through a byte can hold SDA low forever. Close the driver,
+// clock the bus free and open the driver again. Takes well under a millisecond. If an
+// earlier reopen failed there is nothing to close, so this just tries the open again.
+static bool recoverI2C(void)
 {
-    int16_t temperature = 0;
-    i2cTransaction.readCount = 2;
-    if (I2C_transfer(i2c, &i2cTransaction))
+    if (i2c != NULL)
     {
-        /*
-         * Extract degrees C from the received data;
-         * see TMP sensor datasheet
-         */
-        temperature = (rxBuffer[0] << 8) | (rxBuffer[1]);
-        temperature *= 0.0078125;
-        /*
-         * If the MSB is set '1', then we have a 2's complement
-         * negative value which needs to be sign extended
-         */
-        if (rxBuffer[0] & 0x80)
-        {
-            temperature |= 0xF000;
-        }
+        halI2CClose(i2c);
+        i2c = NULL;
     }
-    else
+    i2cBusClear();
+    i2c = halI2COpen(CONFIG_I2C_0, I2C_BIT_RATE);
+
+    return i2c != NULL;
+}
+
+// Reads a sensor into *sample, in units of 1/128 C. On failure the bus is recovered and the
+// read retried once; if that fails too, *sample is left alone and false is returned.
+bool readTemp(uint8_t sensor, int16_t *sample)
+{
+    if (!transferTemp(sensor))
     {
-        DISPLAY(snprintf(output, 64, "Error reading temperature sensor %d\n\r", i2cTransaction.status));
-        DISPLAY(snprintf(output, 64, "Please power cycle your board by unplugging USB and plugging back in.\n\r"));
+        if (!recoverI2C() || !transferTemp(sensor))
+        {
+            char *p = fmtStr(output, "Error reading temperature sensor ");
+            p = fmtInt(p, i2cTransaction.status, 0);
+            p = fmtStr(p, ", holding last reading\n\r");
+            DISPLAY(p - output)
+            return false;
+        }
+        i2cRecoveries++;
     }
 
-    return temperature;
+    /*
+     * The result register is a 2's complement value with 7 fractional bits
+     * (0.0078125 C per LSB); see TMP sensor datasheet. It is kept at full
+     * resolution for filter.c and only rounded to degrees after filtering.
+     */
+    *sample = (int16_t)((rxBuffer[0] << 8) | (rxBuffer[1]));
+
+    return true;
+}
+
+// Averages FILTER_OVERSAMPLE back-to-back reads of a sensor
+static bool sampleSensor(uint8_t sensor, int16_t *sample)
+{
+#if FILTER_OVERSAMPLE > 1
+    int32_t sum = 0;
+    int16_t one;
+    uint8_t k;
+
+    for (k = 0; k < FILTER_OVERSAMPLE; ++k) {
+        if (!readTemp(sensor, &one)) {
+            return false;
+        }
+        sum += one;
+    }
+    *sample = (int16_t)(sum / FILTER_OVERSAMPLE);
+    return true;
+#else
+    return readTemp(sensor, sample);
+#endif
 }
 // ---------------------------------- I2C END ------------------------------------------
 
+/*
+ *  ======== Adaptive sampling ========
+ *  With adaptiveSampling set, the period of TickFct_SetTemp doubles after every round of
+ *  zone reads in which all zones were steady and well away from their setpoints, up to
+ *  SAMPLE_PERIOD_MAX. Any zone near its setpoint or moving drops it straight back to
+ *  SAMPLE_PERIOD_MIN, as does a setpoint change from the buttons or the program.
+ */
+#ifndef ADAPTIVE_SAMPLING
+#define ADAPTIVE_SAMPLING 0
+#endif
+
+#define SAMPLE_PERIOD_MIN   500                                 // ms
+#define SAMPLE_PERIOD_MAX   4000                                // ms
+#define ADAPT_NEAR_BAND     (2 << TEMP_FRACTION_BITS)           // Within 2 C of the setpoint
+#define ADAPT_STEADY_DELTA  (1 << (TEMP_FRACTION_BITS - 2))     // Moved 1/4 C since the last sample
+
+unsigned char adaptiveSampling = ADAPTIVE_SAMPLING;
+static char sampleRoundBusy = 0;    // A zone read in this round needs the fast rate
+
+// Called with a zone's new filtered reading and the one before it
+static void noteSample(uint8_t z, int16_t previous)
+{
+    int16_t fromSet = zones.filteredTemp[z] - (zones.setTempCelsius[z] << TEMP_FRACTION_BITS);
+    int16_t moved = zones.filteredTemp[z] - previous;
+
+    if (fromSet < ADAPT_NEAR_BAND && fromSet > -ADAPT_NEAR_BAND) {
+        sampleRoundBusy = 1;
+    }
+    if (moved >= ADAPT_STEADY_DELTA || moved <= -ADAPT_STEADY_DELTA) {
+        sampleRoundBusy = 1;
+    }
+}
+
+// Called after the last zone of a round has been read
+static void adaptSamplePeriod(void)
+{
+    if (adaptiveSampling) {
+        if (sampleRoundBusy) {
+            taskSetPeriod(TASK_SetTemp, SAMPLE_PERIOD_MIN);
+        } else if (tasks[TASK_SetTemp].period < SAMPLE_PERIOD_MAX) {
+            taskSetPeriod(TASK_SetTemp, tasks[TASK_SetTemp].period * 2);
+        }
+    }
+    sampleRoundBusy = 0;
+}
+
+// A new setpoint goes back to the fast rate, starting with a read on the next tick
+void sampleSoon(void)
+{
+    if (adaptiveSampling) {
+        taskSetPeriod(TASK_SetTemp, SAMPLE_PERIOD_MIN);
+        taskSetPhase(TASK_SetTemp, 0);
+    }
+}
+// ---------------------------------- Adaptive sampling End ----------------------------------
+
 
 /*
  *  ======== gpioButtonFxn0 ========
@@ -239,12 +375,18 @@ int16_t readTemp(void)
  */
 void gpioButtonFxn0(uint_least8_t index)
 {
+    traceEvent(TRACE_Isr, TRACE_IrqButton0, 0);
+    latencyPress(LAT_UpBtn);
     upBtnPressed = 1;
+    recorderLog(REC_UpBtn, 0, 0);
 }
 
 void gpioButtonFxn1(uint_least8_t index)
 {
+    traceEvent(TRACE_Isr, TRACE_IrqButton1, 0);
+    latencyPress(LAT_DownBtn);
     downBtnPressed = 1;
+    recorderLog(REC_DownBtn, 0, 0);
 }
 
 // State machine tick functions
@@ -273,8 +415,11 @@ int TickFct_CheckUpBtn(int state) {
 
     switch(state) {
         case BTN_On:
-            setTempCelsius++;
+            zones.setTempCelsius[selectedZone]++;
             upBtnPressed = 0;
+            programOverride = true;
+            latencyApplied(LAT_UpBtn);
+            sampleSoon();
             break;
         case BTN_Off:
             break;
@@ -308,8 +453,11 @@ int TickFct_CheckDownBtn(int state) {
 
     switch(state) {
         case BTN_On:
-            setTempCelsius--;
+            zones.setTempCelsius[selectedZone]--;
             downBtnPressed = 0;
+            programOverride = true;
+            latencyApplied(LAT_DownBtn);
+            sampleSoon();
             break;
         case BTN_Off:
             break;
@@ -318,55 +466,350 @@ int TickFct_CheckDownBtn(int state) {
     return state;
 }
 
+// The heater state machine for each zone lives in the zone table (see zonesControlPass()),
+// so this task has no state of its own. The duty cycle figures (duty.h) and the PID (control.h)
+// run on this task's period.
 int TickFct_CheckTemp(int state) {
-    switch(state) {
-        case HTR_Off:
-            if (currentTempCelsius < setTempCelsius) {
-                state = HTR_On;
-            } else {
-                state = HTR_Off;
-            }
-            break;
-        case HTR_On:
-            if (currentTempCelsius >= setTempCelsius) {
-                state = HTR_Off;
-            } else {
-                state = HTR_On;
-            }
-            break;
+    dutyAdvance(tasks[TASK_CheckTemp].period);
+    zonesControlPass(tasks[TASK_CheckTemp].period);
+
+    return 0;
+}
+
+/*
+ *  ======== Reporting ========
+ *  REPORT_Periodic sends every zone's report on every run of TickFct_Output. REPORT_OnChange
+ *  only sends a zone's report when its temperature, setpoint or heater state has changed since
+ *  the last one it sent, no more often than reportMinInterval, and at least every reportHeartbeat
+ *  seconds regardless. In that mode each report carries a fifth field with the number of reports
+ *  suppressed since the previous one, so the full 1 s series can be rebuilt downstream.
+ */
+#ifndef REPORT_MODE
+#define REPORT_MODE REPORT_Periodic
+#endif
+
+unsigned char reportMode = REPORT_MODE;
+unsigned long reportMinInterval = 5;    // seconds
+unsigned long reportHeartbeat = 60;     // seconds
+unsigned long reportsSuppressed = 0;    // Total since boot
+
+// Milliseconds since boot, counted in Output periods so that it stays right when the period
+// changes. 64 bits so it doesn't wrap; totalTimeElapsed is the same in whole seconds.
+static uint64_t reportClockMs = 0;
+
+// What each zone last reported, and when
+static struct {
+    int16_t currentTempCelsius[NUM_ZONES];
+    int16_t setTempCelsius[NUM_ZONES];
+    uint8_t heaterState[NUM_ZONES];
+    uint64_t time[NUM_ZONES];           // reportClockMs
+    uint16_t suppressed[NUM_ZONES];     // Reports skipped since the last one sent
+    uint8_t sent[NUM_ZONES];            // The first report always goes out
+} lastReport;
+
+// Decides whether zone z reports on this run, and remembers what it sent if so
+static char reportDue(uint8_t z)
+{
+    char changed;
+    uint64_t since;
+
+    if (reportMode == REPORT_Periodic) {
+        return 1;
     }
 
-    switch(state) {
-        case HTR_Off:
-            heaterOn = 0;
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-            break;
-        case HTR_On:
-            heaterOn = 1;
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
-            break;
+    changed = zones.currentTempCelsius[z] != lastReport.currentTempCelsius[z]
+              || zones.setTempCelsius[z] != lastReport.setTempCelsius[z]
+              || zones.heaterState[z] != lastReport.heaterState[z];
+    since = reportClockMs - lastReport.time[z];
+
+    if (lastReport.sent[z] && !(changed && since >= reportMinInterval * 1000ULL)
+        && since < reportHeartbeat * 1000ULL) {
+        lastReport.suppressed[z]++;
+        reportsSuppressed++;
+        return 0;
     }
 
-    return state;
+    lastReport.currentTempCelsius[z] = zones.currentTempCelsius[z];
+    lastReport.setTempCelsius[z] = zones.setTempCelsius[z];
+    lastReport.heaterState[z] = zones.heaterState[z];
+    lastReport.time[z] = reportClockMs;
+    lastReport.sent[z] = 1;
+    return 1;
 }
 
 // This tick function is really just a state machine with a single state, so state code for it is eliminated
 int TickFct_Output(int state) {
-    totalTimeElapsed++;
+    uint8_t z;
 
-    // Turn on the heater LED if necessary
+    reportClockMs += tasks[TASK_Output].period;
+    totalTimeElapsed = (unsigned long)(reportClockMs / 1000);
 
-    // Output the report to the console
-    DISPLAY(snprintf(output, 64, "<%02d,%02d,%d,%04d>\r\n", currentTempCelsius, setTempCelsius, heaterOn, totalTimeElapsed))
+    // Output the report to the console, one line per zone
+    // "<%02d,%02d,%d,%04d>\r\n", with "%d:" for the zone in front when there are several
+    // and ",%d" suppressed reports on the end in REPORT_OnChange mode
+    for (z = 0; z < NUM_ZONES; ++z) {
+        if (!reportDue(z)) {
+            continue;
+        }
+
+        char *p = fmtChar(output, '<');
+#if NUM_ZONES > 1
+        p = fmtUint(p, z, 0);
+        p = fmtChar(p, ':');
+#endif
+        p = fmtInt(p, zones.currentTempCelsius[z], 2);
+        p = fmtChar(p, ',');
+        p = fmtInt(p, zones.setTempCelsius[z], 2);
+        p = fmtChar(p, ',');
+        p = fmtChar(p, '0' + zones.heaterState[z]);
+        p = fmtChar(p, ',');
+        p = fmtUint(p, totalTimeElapsed, 4);
+        if (reportMode == REPORT_OnChange) {
+            p = fmtChar(p, ',');
+            p = fmtUint(p, lastReport.suppressed[z], 0);
+            lastReport.suppressed[z] = 0;
+        }
+        p = fmtStr(p, ">\r\n");
+        DISPLAY(p - output)
+    }
 
     return 0;
 }
 
-// This tick function is really just a state machine with a single state, so state code for it is eliminated
+// Reads one zone's sensor per tick, round-robin. The state is the zone to read next,
+// so with N zones each zone is sampled every N periods of this task.
+// A zone whose sensor is failing keeps its last good reading and is marked stale.
 int TickFct_SetTemp(int state) {
-    currentTempCelsius = readTemp();
+    uint8_t z = (uint8_t)state;
+    uint8_t backoff;
+    int16_t sample;
 
-    return 0;
+    if (z >= NUM_ZONES) {
+        z = 0;
+    }
+
+    if (sensorBackoff.skip[z]) {
+        sensorBackoff.skip[z]--;
+        i2cSkippedReads++;
+        if (zones.stale[z] < 0xFF) {
+            zones.stale[z]++;
+        }
+    } else if (sampleSensor(zones.sensorIndex[z], &sample)) {
+        int16_t previous = zones.filteredTemp[z];
+
+        // Filtering across a long gap would smear old readings into new ones
+        if (zones.stale[z] > ZONE_STALE_LIMIT) {
+            filterReset(z, sample);
+            previous = sample;
+        }
+        zones.filteredTemp[z] = filterUpdate(z, sample);
+        zones.currentTempCelsius[z] = tempToCelsius(zones.filteredTemp[z]);
+        sensorBackoff.failures[z] = 0;
+        zones.stale[z] = 0;
+        noteSample(z, previous);
+    } else {
+        if (sensorBackoff.failures[z] < 8) {
+            sensorBackoff.failures[z]++;
+        }
+        backoff = 1 << (sensorBackoff.failures[z] - 1);
+        sensorBackoff.skip[z] = (backoff < I2C_MAX_BACKOFF) ? backoff : I2C_MAX_BACKOFF;
+        if (zones.stale[z] < 0xFF) {
+            zones.stale[z]++;
+        }
+    }
+
+    if (z + 1 == NUM_ZONES) {
+        adaptSamplePeriod();
+    }
+
+    return (z + 1) % NUM_ZONES;
+}
+
+// Loads are kept in permille and shown as a percentage with one decimal
+static char *fmtLoad(char *p, uint16_t permille)
+{
+    p = fmtUint(p, permille / 10, 0);
+    p = fmtChar(p, '.');
+    p = fmtUint(p, permille % 10, 0);
+    return fmtChar(p, '%');
+}
+
+// Temperature in 1/128 C as degrees with one decimal
+static char *fmtTenths(char *p, int32_t temp)
+{
+    int32_t tenths = (temp * 10 + (1 << (TEMP_FRACTION_BITS - 1))) >> TEMP_FRACTION_BITS;
+
+    if (tenths < 0) {
+        p = fmtChar(p, '-');
+        tenths = -tenths;
+    }
+    p = fmtUint(p, tenths / 10, 0);
+    p = fmtChar(p, '.');
+    return fmtUint(p, tenths % 10, 0);
+}
+
+// Zone TickFct_Stats is reporting the heater figures of. Kept across yields, so not a local (see pt.h).
+static uint8_t statsZone;
+
+#if SCHED_POLICY == SCHED_EDF
+#define SCHED_NAME "edf"
+#elif SCHED_POLICY == SCHED_PRIORITY
+#define SCHED_NAME "priority"
+#else
+#define SCHED_NAME "array"
+#endif
+
+// Periodic diagnostics. Reports the cost of the last heater control pass per zone,
+// the main loop's CPU load, the deadline misses per task, the button latency and the heater use per zone.
+// Peaks are since the last report.
+// The report goes out one line per tick (see pt.h) so its UART writes don't hold up a whole pass.
+int TickFct_Stats(int state) {
+    char *p;
+    uint8_t z;
+    unsigned char i;
+
+    PT_BEGIN(state);
+
+    // Setpoint keyframes let a replay that starts mid-ring pick up the right setpoints
+    for (z = 0; z < NUM_ZONES; ++z) {
+        recorderLog(REC_Setpoint, z, zones.setTempCelsius[z]);
+    }
+
+    p = fmtStr(output, "#stats zones=");
+    p = fmtUint(p, NUM_ZONES, 0);
+    p = fmtStr(p, " cyc/zone=");
+    p = fmtUint(p, zonePassCycles / NUM_ZONES, 0);
+    p = fmtStr(p, " suppressed=");
+    p = fmtUint(p, reportsSuppressed, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    p = fmtStr(output, "#stats i2c reads=");
+    p = fmtUint(p, i2cReads, 0);
+    p = fmtStr(p, " fail=");
+    p = fmtUint(p, i2cFailures, 0);
+    p = fmtStr(p, " recovered=");
+    p = fmtUint(p, i2cRecoveries, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    p = fmtStr(output, "#stats sample skipped=");
+    p = fmtUint(p, i2cSkippedReads, 0);
+    p = fmtStr(p, " period=");
+    p = fmtUint(p, tasks[TASK_SetTemp].period, 0);
+    p = fmtStr(p, " tick=");
+    p = fmtUint(p, timerPeriod, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    p = fmtStr(output, "#stats load 1s=");
+    p = fmtLoad(p, cpuLoad1s);
+    p = fmtStr(p, " 10s=");
+    p = fmtLoad(p, cpuLoad10s);
+    p = fmtStr(p, " 60s=");
+    p = fmtLoad(p, cpuLoad60s);
+    p = fmtStr(p, " peak=");
+    p = fmtLoad(p, cpuLoadPeak);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    cpuLoadPeakReset();
+    PT_YIELD();
+
+    p = fmtStr(output, "#stats sched=" SCHED_NAME " miss=");
+    for (i = 0; i < numTasks; ++i) {
+        p = (i > 0) ? fmtChar(p, '/') : p;
+        p = fmtUint(p, taskStats.misses[i], 0);
+    }
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    // A line of its own: with the misses, six full width figures each would overrun output[]
+    p = fmtStr(output, "#stats sched=" SCHED_NAME " maxlat_us=");
+    for (i = 0; i < numTasks; ++i) {
+        p = (i > 0) ? fmtChar(p, '/') : p;
+        p = fmtUint(p, taskStats.maxLatencyUs[i], 0);
+        taskStats.maxLatencyUs[i] = 0;
+    }
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    // Button press to setpoint change, since power up
+    p = fmtStr(output, "#stats press n=");
+    p = fmtUint(p, pressLatency.count, 0);
+    p = fmtStr(p, " p50_ms=");
+    p = fmtUint(p, latencyPercentile(&pressLatency, 50) / 1000, 0);
+    p = fmtStr(p, " p99_ms=");
+    p = fmtUint(p, latencyPercentile(&pressLatency, 99) / 1000, 0);
+    p = fmtStr(p, " max_ms=");
+    p = fmtUint(p, pressLatency.maxUs / 1000, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    // Setpoint program, see program.h
+    p = fmtStr(output, "#stats program running=");
+    p = fmtUint(p, programRunning, 0);
+    p = fmtStr(p, " entries=");
+    p = fmtUint(p, programLength, 0);
+    p = fmtStr(p, " next=");
+    p = fmtUint(p, programLength ? PROGRAM_MINUTE(program[programNext]) : 0, 0);
+    p = fmtStr(p, " override=");
+    p = fmtUint(p, programOverride, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+    PT_YIELD();
+
+    // Saved settings, see settings.h
+    p = fmtStr(output, "#stats settings loaded=");
+    p = fmtUint(p, settingsLoaded, 0);
+    p = fmtStr(p, " writes=");
+    p = fmtUint(p, settingsWrites, 0);
+    p = fmtStr(p, " failures=");
+    p = fmtUint(p, settingsWriteFailures, 0);
+    p = fmtStr(p, "\r\n");
+    DISPLAY(p - output)
+
+    // Heater use since power up, see duty.h
+    for (statsZone = 0; statsZone < NUM_ZONES; ++statsZone) {
+        PT_YIELD();
+        z = statsZone;
+        p = fmtStr(output, "#stats heat z=");
+        p = fmtUint(p, z, 0);
+        p = fmtStr(p, " on_s=");
+        p = fmtUint(p, (uint32_t)(dutyOnMs(z) / 1000), 0);
+        p = fmtStr(p, " duty=");
+        p = fmtLoad(p, dutyPermille(z));
+        p = fmtStr(p, " cph=");
+        p = fmtUint(p, dutyCyclesPerHour(z), 0);
+        p = fmtStr(p, " wh=");
+        p = fmtUint(p, dutyWattHours(z), 0);
+        p = fmtStr(p, "\r\n");
+        DISPLAY(p - output)
+        PT_YIELD();
+
+        z = statsZone;
+        p = fmtStr(output, "#stats heat z=");
+        p = fmtUint(p, z, 0);
+        p = fmtStr(p, " mean_on_s=");
+        p = fmtUint(p, duty.onCount[z] ? (uint32_t)(duty.onMs[z] / duty.onCount[z] / 1000) : 0, 0);
+        p = fmtStr(p, " mean_off_s=");
+        p = fmtUint(p, duty.offCount[z] ? (uint32_t)(duty.offMs[z] / duty.offCount[z] / 1000) : 0, 0);
+        p = fmtStr(p, " overshoot_c=");
+        p = fmtTenths(p, duty.overshootCount[z] ? (int32_t)(duty.overshootSum[z] / duty.overshootCount[z]) : 0);
+        p = fmtStr(p, " max_c=");
+        p = fmtTenths(p, duty.overshootMax[z]);
+        p = fmtStr(p, " settle_s=");
+        p = fmtUint(p, duty.settleMs[z] / 1000, 0);
+        p = fmtStr(p, "\r\n");
+        DISPLAY(p - output)
+    }
+
+    PT_END();
 }
 
 /*
@@ -378,29 +821,20 @@ volatile unsigned char TimerFlag = 0;
 
 void timerCallback(Timer_Handle myHandle, int_fast16_t status)
 {
+    traceEvent(TRACE_Isr, TRACE_IrqTimer, 0);
     timerFlag = 1;
+    supervisorTick(timerPeriod);
 }
 
 void initTimer(void)
 {
-    Timer_Params params;
-    // Init the driver
-    Timer_init();
-    // Configure the driver
-    Timer_Params_init(&params);
-    //Every 100 milliseconds
-    params.period = 1000000;
-    params.periodUnits = Timer_PERIOD_US;
-    params.timerMode = Timer_CONTINUOUS_CALLBACK;
-    params.timerCallback = timerCallback;
-
-    // Open the driver
-    timer0 = Timer_open(CONFIG_TIMER_0, &params);
+    // One base tick. The scheduler changes it with halTimerSetPeriod() when the task periods change.
+    timer0 = halTimerOpen(CONFIG_TIMER_0, timerPeriod * 1000, Timer_CONTINUOUS_CALLBACK, timerCallback);
     if (timer0 == NULL) {
         /* Failed to initialized timer */
         while (1) {}
     }
-    if (Timer_start(timer0) == Timer_STATUS_ERROR) {
+    if (!halTimerStart(timer0)) {
         /* Failed to start timer */
         while (1) {}
     }
@@ -408,98 +842,385 @@ void initTimer(void)
 // ---------------------------------- Timer End ------------------------------------------
 
 /*
- *  ======== mainThread ========
+ *  ======== Scheduler ========
  */
-void *mainThread(void *arg0)
+// Base tick waiting to be applied at the end of the current runTasks() pass, 0 if none
+static unsigned long pendingTimerPeriod = 0;
+
+static unsigned long gcd(unsigned long a, unsigned long b)
 {
-    /* Call driver init functions */
-    GPIO_init();
+    unsigned long t;
 
-    /* Configure the LED and button pins */
-    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
-    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
-    GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+    while (b != 0) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
 
-    /* Install Button callbacks */
-    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, gpioButtonFxn0);
-    GPIO_setCallback(CONFIG_GPIO_BUTTON_1, gpioButtonFxn1);
+// The base tick is the largest period that every enabled task's period and SCHED_MAX_TICK
+// are multiples of. It is only worked out here; runTasks() changes the timer once its pass
+// is over so that every task in the pass is charged for the tick that actually went by.
+static void schedulerRetime(void)
+{
+    unsigned long tick = SCHED_MAX_TICK;
+    unsigned char i;
 
-    /* Enable interrupts */
-    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
-    GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
+    for (i = 0; i < numTasks; ++i) {
+        if (tasks[i].enabled) {
+            tick = gcd(tasks[i].period, tick);
+        }
+    }
+    pendingTimerPeriod = (tick != timerPeriod) ? tick : 0;
+}
 
-    // Initialize the board components. Timer inits with a default 100ms period to accommodate both 200ms and 500ms intervals
-    initUART();
-    initI2C();
-    initTimer();
+static void schedulerApplyTick(void)
+{
+    if (pendingTimerPeriod == 0) {
+        return;
+    }
+    // If the timer refuses the new period the old tick is kept. Tasks still run, just
+    // rounded up to the next multiple of the old tick.
+    if (timer0 == NULL || halTimerSetPeriod(timer0, pendingTimerPeriod * 1000)) {
+        timerPeriod = pendingTimerPeriod;
+    }
+    pendingTimerPeriod = 0;
+}
 
-    // Set the current temp to start to make sure that the check temp state machine doesn't inadvertently
-    // turn on the heater before we've accurately captured the current temp
-    DISPLAY(snprintf(output, 64, "Reading temperature\n\r"));
-    currentTempCelsius = readTemp();
-    DISPLAY(snprintf(output, 64, "Current temperature %02d\n\r", currentTempCelsius));
+static unsigned long roundToGranule(unsigned long ms)
+{
+    return (ms + TASK_PERIOD_GRANULE - 1) / TASK_PERIOD_GRANULE * TASK_PERIOD_GRANULE;
+}
 
-    // Set up the tasks to be handled
+// Set up the tasks to be handled. Periods and deadlines are in milliseconds. The buttons
+// get the tightest deadlines and the top priority so a slow report can't hold them up.
+void initTasks(void)
+{
     unsigned char i = 0;
-    tasks[i].state = 0;                     // The first task has no states. It just always sets the current temperature
-    tasks[i].period = 50;
+
+    tasks[i].state = 0;                     // The first task's state is the next zone to read
+    tasks[i].period = 500;
     tasks[i].elapsedTime = tasks[i].period; // All elapsed times will be set to the period so that the init state will run at start-up
+    tasks[i].deadline = 200;                // Same as CheckTemp, and ahead of it in tasks[] so a
+    tasks[i].priority = 1;                  // new reading is used by the control pass of the same tick
     tasks[i].TickFct = &TickFct_SetTemp;
     ++i;
     tasks[i].state = BTN_Off;
-    tasks[i].period = 20;
+    tasks[i].period = 200;
     tasks[i].elapsedTime = tasks[i].period;
+    tasks[i].deadline = 100;
+    tasks[i].priority = 0;
     tasks[i].TickFct = &TickFct_CheckUpBtn;
     ++i;
     tasks[i].state = BTN_Off;
-    tasks[i].period = 20;
+    tasks[i].period = 200;
     tasks[i].elapsedTime = tasks[i].period;
+    tasks[i].deadline = 100;
+    tasks[i].priority = 0;
     tasks[i].TickFct = &TickFct_CheckDownBtn;
     ++i;
-    tasks[i].state = HTR_Off;
-    tasks[i].period = 50;
+    tasks[i].state = 0;                     // Heater states are kept per zone in the zone table
+    tasks[i].period = 500;
     tasks[i].elapsedTime = tasks[i].period;
+    tasks[i].deadline = 200;
+    tasks[i].priority = 1;
     tasks[i].TickFct = &TickFct_CheckTemp;
     ++i;
     tasks[i].state = 0;
-    tasks[i].period = 100;
+    tasks[i].period = 1000;
     tasks[i].elapsedTime = tasks[i].period;
+    tasks[i].deadline = 1000;
+    tasks[i].priority = 3;
     tasks[i].TickFct = &TickFct_Output;
+    ++i;
+    tasks[i].state = 0;
+    tasks[i].period = 10000;
+    tasks[i].elapsedTime = 0;               // First stats report after one full period
+    tasks[i].deadline = 10000;
+    tasks[i].priority = 4;
+    tasks[i].TickFct = &TickFct_Stats;
 
-    while(1) {
+    for (i = 0; i < numTasks; ++i) {
+        tasks[i].enabled = 1;
+        tasks[i].coroutine = (i == TASK_Stats);
+        supervisorCheckIn(i);
+    }
+    schedulerRetime();
+    wheelInit();
+    programInit();
+    controlInit();
+    settingsInit();
+}
+
+// Change how often a task runs. Time it has already waited counts towards the new period.
+bool taskSetPeriod(unsigned char id, unsigned long period)
+{
+    if (id >= numTasks || period == 0 || period > TASK_PERIOD_MAX) {
+        return false;
+    }
+    tasks[id].period = roundToGranule(period);
+    supervisorCheckIn(id);
+    schedulerRetime();
+    return true;
+}
+
+// Run a task delay milliseconds from now and every period after that. A delay of 0 runs
+// it on the next tick. Delays that are not a multiple of the base tick are rounded up by it.
+bool taskSetPhase(unsigned char id, unsigned long delay)
+{
+    if (id >= numTasks || delay > tasks[id].period) {
+        return false;
+    }
+    tasks[id].elapsedTime = tasks[id].period - roundToGranule(delay);
+    return true;
+}
+
+// A disabled task keeps its place and carries on from it when it is enabled again.
+// CheckTemp can't be disabled since that would leave the heaters stuck where they are.
+bool taskEnable(unsigned char id, bool enabled)
+{
+    if (id >= numTasks || (id == TASK_CheckTemp && !enabled)) {
+        return false;
+    }
+    tasks[id].enabled = enabled;
+    supervisorCheckIn(id);
+    schedulerRetime();
+    return true;
+}
+
+// Counts a run of a task that started latencyUs after it was due
+void taskNoteLatency(unsigned char i, unsigned long latencyUs)
+{
+    ++taskStats.runs[i];
+    if (latencyUs > tasks[i].deadline * 1000) {
+        ++taskStats.misses[i];
+    }
+    if (latencyUs > taskStats.maxLatencyUs[i]) {
+        taskStats.maxLatencyUs[i] = latencyUs;
+    }
+    if (latencyUs > taskStats.worstLatencyUs[i]) {
+        taskStats.worstLatencyUs[i] = latencyUs;
+    }
+}
+
+// Runs one task's tick function
+void taskRun(unsigned char i)
+{
+    supervisorRunning = i;
+    traceEvent(TRACE_TaskBegin, i, 0);
+    //tasks[i].state = tasks[i].TickFct(tasks[i].state);
+    switch (i) {
+        case TASK_SetTemp:
+            tasks[i].state = TickFct_SetTemp(tasks[i].state);
+            break;
+        case TASK_CheckUpBtn:
+            tasks[i].state = TickFct_CheckUpBtn(tasks[i].state);
+            break;
+        case TASK_CheckDownBtn:
+            tasks[i].state = TickFct_CheckDownBtn(tasks[i].state);
+            break;
+        case TASK_CheckTemp:
+            tasks[i].state = TickFct_CheckTemp(tasks[i].state);
+            break;
+        case TASK_Output:
+            tasks[i].state = TickFct_Output(tasks[i].state);
+            break;
+        case TASK_Stats:
+            tasks[i].state = TickFct_Stats(tasks[i].state);
+            break;
+        default:
+            break;
+    }   // end switch
+    traceEvent(TRACE_TaskEnd, i, 0);
+    supervisorCheckIn(i);
+    supervisorRunning = SUPERVISOR_NO_TASK;
+}
+
+// True while a coroutine task is part way through a run
+bool taskInProgress(unsigned char i)
+{
+    return tasks[i].coroutine && tasks[i].state != 0;
+}
+
+static void runTask(unsigned char i, uint32_t passStart)
+{
+    // Only the start of a coroutine's run counts towards its latency
+    if (!taskInProgress(i)) {
+        taskNoteLatency(i, (tasks[i].elapsedTime - tasks[i].period) * 1000 + (cyclesNow() - passStart) / CYCLES_PER_US);
+    }
+    taskRun(i);
+    // A coroutine that yielded stays due so it carries on next tick. Its next period
+    // starts once it finishes.
+    if (!taskInProgress(i)) {
+        tasks[i].elapsedTime = 0;
+    }
+}
+
+#if SCHED_POLICY != SCHED_ARRAY
+// The ready task that should run next, or SUPERVISOR_NO_TASK if none are ready. Ties go
+// to the task earlier in tasks[]. Tasks with their bit set in ran have had their turn this
+// pass: a coroutine that yielded is still due, but its next slice waits for the next tick.
+static unsigned char pickTask(uint32_t ran)
+{
+    unsigned char i;
+    unsigned char best = SUPERVISOR_NO_TASK;
+    long key;
+    long bestKey = 0;
+
+    for (i = 0; i < numTasks; ++i) {
+        if (!tasks[i].enabled || tasks[i].elapsedTime < tasks[i].period || (ran >> i) & 1) {
+            continue;
+        }
+#if SCHED_POLICY == SCHED_EDF
+        // Time left until the deadline. Every task is measured from the same tick.
+        key = (long)(tasks[i].period + tasks[i].deadline) - (long)tasks[i].elapsedTime;
+#else
+        key = tasks[i].priority;
+#endif
+        if (best == SUPERVISOR_NO_TASK || key < bestKey) {
+            best = i;
+            bestKey = key;
+        }
+    }
+    return best;
+}
+#endif
+
+// One pass over the task table, run once for every timer tick
+void runTasks(void)
+{
+    unsigned char i;
+    uint32_t passStart = cyclesNow();
+#if SCHED_POLICY != SCHED_ARRAY
+    uint32_t ran = 0;
+#endif
+
+    recorderLog(REC_Tick, 0, 0);
+
+#if SCHED_POLICY == SCHED_ARRAY
+    // For each tasks, if the amount of time that it's been waiting is at least as long as the period then
+    // we need to go ahead and run that task
+    for (i = 0; i < numTasks; ++i) {
+        if (tasks[i].enabled && tasks[i].elapsedTime >= tasks[i].period) {
+            runTask(i, passStart);
+        }
+    }
+#else
+    // Run the ready tasks best first. If the next tick comes in while a task is running the
+    // pass stops there, so the tasks that tick makes due are weighed against the ones still
+    // waiting instead of queueing behind them.
+    while ((i = pickTask(ran)) != SUPERVISOR_NO_TASK) {
+        runTask(i, passStart);
+        ran |= 1UL << i;
         if (timerFlag) {
-            // For each tasks, if the amount of time that it's been waiting is at least as long as the period then
-            // we need to go ahead and run that task
-            for (i = 0; i < numTasks; ++i) {
-                if (tasks[i].elapsedTime >= tasks[i].period) {
-                    //tasks[i].state = tasks[i].TickFct(tasks[i].state);
-                    switch (i) {
-                        case 0:
-                            tasks[i].state = TickFct_SetTemp(tasks[i].state);
-                            break;
-                        case 1:
-                            tasks[i].state = TickFct_CheckUpBtn(tasks[i].state);
-                            break;
-                        case 2:
-                            tasks[i].state = TickFct_CheckDownBtn(tasks[i].state);
-                            break;
-                        case 3:
-                            tasks[i].state = TickFct_CheckTemp(tasks[i].state);
-                            break;
-                        case 4:
-                            tasks[i].state = TickFct_Output(tasks[i].state);
-                            break;
-                        default:
-                            break;
-                    }   // end switch
-                    tasks[i].elapsedTime = 0;
-                }   // end if elapsed time
-                tasks[i].elapsedTime += timerPeriod;
-            }   // end for loop
+            break;
+        }
+    }
+#endif
+
+    for (i = 0; i < numTasks; ++i) {
+        if (tasks[i].enabled) {
+            tasks[i].elapsedTime += timerPeriod;
+        }
+    }   // end for loop
+
+    // Software timers, see timerwheel.h
+    wheelAdvance(timerPeriod);
+
+    schedulerApplyTick();
+}
+// ---------------------------------- Scheduler End ------------------------------------------
+
+/*
+ *  ======== mainThread ========
+ */
+void *mainThread(void *arg0)
+{
+    char *p;
+#if !defined(THERMOSTAT_FREERTOS)
+    uint32_t busyStart;
+    unsigned long tick;
+#endif
+
+    /* Call driver init functions */
+    halGpioInit();
+
+    /* Configure the LED, and the buttons with their callbacks and interrupts */
+    halOutputInit(CONFIG_GPIO_LED_0);
+    halButtonInit(CONFIG_GPIO_BUTTON_0, gpioButtonFxn0);
+    halButtonInit(CONFIG_GPIO_BUTTON_1, gpioButtonFxn1);
+
+    // The watchdog goes first so that a stuck init ends in a reset too
+    supervisorInit();
+
+    // Initialize the board components. Timer inits with a default 100ms period to accommodate both 200ms and 500ms intervals
+    cyclesInit();
+    traceInit();
+    initUART();
+    initI2C();
+    initTimer();
+
+    // Bind each zone to the next sensor that answered the scan
+    zonesInit(DEFAULT_SET_TEMP, DEFAULT_HYSTERESIS);
+    unsigned char i = 0;
+    for (i = 0; i < NUM_ZONES && i < numDetectedSensors; ++i) {
+        zones.sensorIndex[i] = detectedSensors[i];
+    }
+
+    // The setpoints and tunables saved before the last reset, put into effect by initTasks()
+    settingsLoad();
+
+    // Set the current temp to start to make sure that the check temp state machine doesn't inadvertently
+    // turn on the heater before we've accurately captured the current temp
+    DISPLAY_STR("Reading temperature\n\r")
+    for (i = 0; i < NUM_ZONES; ++i) {
+        int16_t sample;
+        if (sampleSensor(zones.sensorIndex[i], &sample)) {
+            filterReset(i, sample);
+            zones.filteredTemp[i] = sample;
+            zones.currentTempCelsius[i] = tempToCelsius(sample);
+            zones.stale[i] = 0;
+        }
+        p = fmtStr(output, "Current temperature ");
+        p = fmtInt(p, zones.currentTempCelsius[i], 2);
+        p = fmtStr(p, "\n\r");
+        DISPLAY(p - output)
+    }
+
+    initTasks();
+    commandStart(uart);
 
+#if defined(THERMOSTAT_FREERTOS)
+    // Each task gets its own thread, see threads.h. This thread's job is done.
+    threadsStart();
+#else
+    cpuLoadInit();
+
+    while(1) {
+        if (timerFlag) {
+            // Cleared before the pass so that a tick which comes in during it isn't lost
             timerFlag = 0;
+            // Everything until the pass is over is busy time, see cpuload.h
+            busyStart = cyclesNow();
+            tick = timerPeriod;
+
+            // Pressing both buttons together dumps the event trace and the flight recorder to the console
+            if (upBtnPressed && downBtnPressed) {
+                supervisorSuspend();
+                // The trace goes first, before the recorder dump fills it with UART writes
+                traceExport(uart);
+                recorderExport(uart);
+                supervisorResume();
+            }
+
+            runTasks();
+            cpuLoadTick(cyclesNow() - busyStart, tick);
         }   // end if (timerFlag)
+
+        commandPoll();
     }   // end while(1)
+#endif
 
     return (NULL);
 }
@@ -0,0 +1,116 @@
+/*
+ *  ======== gpiointerrupt.h ========
+ *  Thermostat application pieces shared with the host tools in ../host.
+ */
+#ifndef GPIOINTERRUPT_H_
+#define GPIOINTERRUPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/UART.h>
+
+#define DEFAULT_SET_TEMP    22
+#define DEFAULT_HYSTERESIS  0
+
+// Set up a task type to track each tasks's relevant information
+// Code adapted from Emerging Systems Architectures and Technologies, ZyBooks ISBN: 979-8-203-05560-6
+#define NUM_TASKS 6
+
+// Index of each task in tasks[]
+enum TASK_Ids { TASK_SetTemp, TASK_CheckUpBtn, TASK_CheckDownBtn, TASK_CheckTemp, TASK_Output, TASK_Stats };
+
+// Order in which the tasks that are ready in a scheduler pass get run, picked at build time
+#define SCHED_ARRAY     0       // tasks[] order, every ready task in one pass
+#define SCHED_PRIORITY  1       // Lowest priority value first, each task run to completion
+#define SCHED_EDF       2       // Nearest deadline first, each task run to completion
+
+#ifndef SCHED_POLICY
+#define SCHED_POLICY SCHED_ARRAY
+#endif
+
+typedef struct task {
+    int state;
+    unsigned long period;
+    unsigned long elapsedTime;
+    unsigned long deadline;     // Milliseconds after the task is due that it must have started by
+    unsigned char priority;     // 0 is the most urgent, used by SCHED_PRIORITY
+    unsigned char enabled;
+    unsigned char coroutine;    // TickFct is written with pt.h and may run over several ticks
+    int (*TickFct)(int);        // Pointer to the tasks processing function
+} task;
+
+// Task periods and phases are rounded up to this many milliseconds. The base
+// tick is the GCD of the enabled periods, so it is never shorter than this.
+#define TASK_PERIOD_GRANULE 10
+
+// Longest base tick, whatever the enabled periods are. The timer interrupt feeds the
+// watchdog once a tick (see supervisor.h), so this has to stay well inside its period.
+// A multiple of TASK_PERIOD_GRANULE.
+#define SCHED_MAX_TICK 500
+
+// Longest task period, the last granule that fits the 16 bit field settings.h saves it in
+#define TASK_PERIOD_MAX (UINT16_MAX / TASK_PERIOD_GRANULE * TASK_PERIOD_GRANULE)
+
+enum BTN_States { BTN_Off, BTN_On };
+enum REPORT_Modes { REPORT_Periodic, REPORT_OnChange };
+
+// Per-task deadline statistics. A task's latency runs from the tick it became due
+// to the start of its tick function.
+typedef struct taskTiming {
+    unsigned long runs[NUM_TASKS];
+    unsigned long misses[NUM_TASKS];        // Runs that started after their deadline
+    unsigned long maxLatencyUs[NUM_TASKS];  // Since the last stats report
+    unsigned long worstLatencyUs[NUM_TASKS];    // Since boot
+} taskTiming;
+
+extern task tasks[NUM_TASKS];
+extern taskTiming taskStats;
+extern const unsigned char numTasks;
+extern unsigned long timerPeriod;
+extern unsigned long totalTimeElapsed;     // Seconds since boot, the reports' time column
+extern volatile char timerFlag;
+extern char upBtnPressed;
+extern char downBtnPressed;
+extern UART_Handle uart;
+
+// Report line rate control, see TickFct_Output()
+extern unsigned char reportMode;
+extern unsigned long reportMinInterval;
+extern unsigned long reportHeartbeat;
+extern unsigned long reportsSuppressed;
+
+extern unsigned char adaptiveSampling;
+
+extern unsigned long i2cReads;
+extern unsigned long i2cFailures;
+extern unsigned long i2cRecoveries;
+extern unsigned long i2cSkippedReads;
+
+// State machine tick function declarations
+int TickFct_SetTemp(int state);
+int TickFct_CheckUpBtn(int state);
+int TickFct_CheckDownBtn(int state);
+int TickFct_CheckTemp(int state);
+int TickFct_Output(int state);
+int TickFct_Stats(int state);
+
+void initUART(void);
+void initI2C(void);
+bool readTemp(uint8_t sensor, int16_t *sample);
+void gpioButtonFxn0(uint_least8_t index);
+void gpioButtonFxn1(uint_least8_t index);
+void initTasks(void);
+void runTasks(void);
+void taskRun(unsigned char id);
+bool taskInProgress(unsigned char id);
+void taskNoteLatency(unsigned char id, unsigned long latencyUs);
+void sampleSoon(void);
+
+// Run-time scheduler control. The base tick is recomputed at the end of the
+// next runTasks() pass. Each returns false for a bad task id or value.
+bool taskSetPeriod(unsigned char id, unsigned long period);
+bool taskSetPhase(unsigned char id, unsigned long delay);
+bool taskEnable(unsigned char id, bool enabled);
+
+#endif /* GPIOINTERRUPT_H_ */
@@ -0,0 +1,80 @@
+/*
+ *  ======== i2cbusclear.c ========
+ *  I2C bus clear for the LaunchPad I2C pins, done with driverlib since the I2C
+ *  driver has no way to drive SCL by hand.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/devices/cc32xx/inc/hw_types.h>
+#include <ti/devices/cc32xx/inc/hw_memmap.h>
+#include <ti/devices/cc32xx/driverlib/rom_map.h>
+#include <ti/devices/cc32xx/driverlib/gpio.h>
+#include <ti/devices/cc32xx/driverlib/pin.h>
+#include <ti/devices/cc32xx/driverlib/prcm.h>
+#include <ti/devices/cc32xx/driverlib/utils.h>
+
+#include "i2cbusclear.h"
+
+// LaunchPad I2C: SCL on pin 1 (GPIO10) and SDA on pin 2 (GPIO11), both in GPIOA1
+#define SCL_PIN         PIN_01
+#define SDA_PIN         PIN_02
+#define SCL_BIT         0x04
+#define SDA_BIT         0x08
+
+// UtilsDelay() spins 3 cycles per count, so this is about 5 us at 80 MHz (100 kHz clock)
+#define HALF_BIT_DELAY  133
+
+static void setScl(bool high)
+{
+    MAP_GPIOPinWrite(GPIOA1_BASE, SCL_BIT, high ? SCL_BIT : 0);
+    MAP_UtilsDelay(HALF_BIT_DELAY);
+}
+
+// SDA is an input while it is released, so that reading it gives the bus level. Read back as
+// an output, the pin only reports what the chip itself is driving.
+static void setSda(bool high)
+{
+    if (high) {
+        MAP_GPIODirModeSet(GPIOA1_BASE, SDA_BIT, GPIO_DIR_MODE_IN);
+    } else {
+        MAP_GPIOPinWrite(GPIOA1_BASE, SDA_BIT, 0);
+        MAP_GPIODirModeSet(GPIOA1_BASE, SDA_BIT, GPIO_DIR_MODE_OUT);
+    }
+    MAP_UtilsDelay(HALF_BIT_DELAY);
+}
+
+bool i2cBusClear(void)
+{
+    uint8_t i;
+    bool released;
+
+    // Take both pins over as open drain GPIO: SCL driven high, SDA released to the pull-up
+    MAP_PRCMPeripheralClkEnable(PRCM_GPIOA1, PRCM_RUN_MODE_CLK);
+    MAP_PinTypeGPIO(SCL_PIN, PIN_MODE_0, false);
+    MAP_PinTypeGPIO(SDA_PIN, PIN_MODE_0, false);
+    MAP_PinConfigSet(SCL_PIN, PIN_STRENGTH_2MA, PIN_TYPE_OD_PU);
+    MAP_PinConfigSet(SDA_PIN, PIN_STRENGTH_2MA, PIN_TYPE_OD_PU);
+    MAP_GPIODirModeSet(GPIOA1_BASE, SCL_BIT, GPIO_DIR_MODE_OUT);
+    setScl(true);
+    setSda(true);
+
+    // Up to nine clocks finishes whatever byte the slave thinks it is sending
+    for (i = 0; i < 9 && !MAP_GPIOPinRead(GPIOA1_BASE, SDA_BIT); ++i) {
+        setScl(false);
+        setScl(true);
+    }
+    released = MAP_GPIOPinRead(GPIOA1_BASE, SDA_BIT) != 0;
+
+    // STOP condition: SDA rises while SCL is high. Only here is SDA driven.
+    setScl(false);
+    setSda(false);
+    setScl(true);
+    setSda(true);
+
+    // Hand the pins back to the I2C peripheral; I2C_open() finishes configuring them
+    MAP_PinTypeI2C(SCL_PIN, PIN_MODE_1);
+    MAP_PinTypeI2C(SDA_PIN, PIN_MODE_1);
+
+    return released;
+}
@@ -0,0 +1,13 @@
+/*
+ *  ======== i2cbusclear.h ========
+ */
+#ifndef I2CBUSCLEAR_H_
+#define I2CBUSCLEAR_H_
+
+#include <stdbool.h>
+
+// Clocks SCL by hand until a slave stuck mid-byte releases SDA, then sends a STOP.
+// Only call this with the I2C driver closed. Returns true if SDA was released.
+bool i2cBusClear(void);
+
+#endif /* I2CBUSCLEAR_H_ */
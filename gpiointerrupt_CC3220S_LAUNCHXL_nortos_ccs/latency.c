@@ -0,0 +1,78 @@
+/*
+ *  ======== latency.c ========
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cycles.h"
+#include "latency.h"
+
+latencyHistogram pressLatency;
+
+static uint32_t pressCycles[LAT_NUM_SOURCES];
+static volatile bool pressPending[LAT_NUM_SOURCES];
+
+// Called from the button interrupt
+void latencyPress(uint8_t source)
+{
+    if (!pressPending[source]) {
+        pressCycles[source] = cyclesNow();
+        pressPending[source] = true;
+    }
+}
+
+// Called by the button task when the press has changed the setpoint
+void latencyApplied(uint8_t source)
+{
+    uint32_t us;
+    uint32_t b;
+
+    if (!pressPending[source]) {
+        return;
+    }
+    us = (cyclesNow() - pressCycles[source]) / CYCLES_PER_US;
+    pressPending[source] = false;
+
+    b = us / LATENCY_BUCKET_US;
+    if (b >= LATENCY_BUCKETS) {
+        b = LATENCY_BUCKETS - 1;
+    }
+    if (pressLatency.bucket[b] < 0xFFFF) {
+        ++pressLatency.bucket[b];
+    }
+    ++pressLatency.count;
+    if (us > pressLatency.maxUs) {
+        pressLatency.maxUs = us;
+    }
+}
+
+// Upper edge of the bucket that holds the given percentile, in us. 0 if nothing has been counted.
+uint32_t latencyPercentile(const latencyHistogram *h, uint8_t percent)
+{
+    uint32_t total = 0;
+    uint32_t seen = 0;
+    uint32_t target;
+    uint16_t b;
+
+    for (b = 0; b < LATENCY_BUCKETS; ++b) {
+        total += h->bucket[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the sample, rounded up so that p100 is the largest
+    target = (total * percent + 99) / 100;
+    for (b = 0; b < LATENCY_BUCKETS; ++b) {
+        seen += h->bucket[b];
+        if (seen >= target && seen > 0) {
+            break;
+        }
+    }
+    return (b + 1) * LATENCY_BUCKET_US;
+}
+
+void latencyReset(latencyHistogram *h)
+{
+    memset(h, 0, sizeof(*h));
+}
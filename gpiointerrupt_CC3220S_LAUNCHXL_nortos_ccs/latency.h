@@ -0,0 +1,34 @@
+/*
+ *  ======== latency.h ========
+ *  Button press to setpoint change latency.
+ *
+ *  The button interrupt stamps the press with the cycle counter and the
+ *  button task stamps the moment it applies the change. The difference goes
+ *  into a histogram of LATENCY_BUCKET_US wide buckets; the last one also takes
+ *  everything longer. A second press before the first is applied is counted
+ *  from the first.
+ */
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+
+#define LATENCY_BUCKET_US   2000
+#define LATENCY_BUCKETS     128
+
+enum LAT_Sources { LAT_UpBtn, LAT_DownBtn, LAT_NUM_SOURCES };
+
+typedef struct latencyHistogram {
+    uint16_t bucket[LATENCY_BUCKETS];   // Saturates at 0xFFFF
+    uint32_t count;
+    uint32_t maxUs;
+} latencyHistogram;
+
+extern latencyHistogram pressLatency;
+
+void latencyPress(uint8_t source);
+void latencyApplied(uint8_t source);
+uint32_t latencyPercentile(const latencyHistogram *h, uint8_t percent);
+void latencyReset(latencyHistogram *h);
+
+#endif /* LATENCY_H_ */
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2017-2020, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== main_freertos.c ========
+ *  Entry point of the FreeRTOS build configuration. Add a CCS build configuration
+ *  that defines THERMOSTAT_FREERTOS, links the SDK's FreeRTOS kernel and POSIX
+ *  libraries in place of NoRTOS, and adds their include paths. The NoRTOS build
+ *  uses main_nortos.c.
+ *
+ *  The SimpleLink host driver needs its spawn thread, sl_Task(), running under an
+ *  RTOS, or sl_Start() in settingsLoad() never returns. It is started here ahead of
+ *  mainThread() and above every application thread, as in the SDK's examples.
+ */
+#if defined(THERMOSTAT_FREERTOS)
+
+#include <stdint.h>
+
+/* POSIX Header files */
+#include <pthread.h>
+
+/* RTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <ti/drivers/Board.h>
+#include <ti/drivers/net/wifi/simplelink.h>
+
+extern void *mainThread(void *arg0);
+
+/* Stack size in bytes */
+#define THREADSTACKSIZE    2048
+
+/* The SimpleLink spawn thread, above THREAD_PRIORITY_TOP in threads.h */
+#define SPAWN_TASK_PRIORITY    9
+#define SPAWN_STACK_SIZE       2048
+
+/*
+ *  ======== main ========
+ */
+int main(void)
+{
+    pthread_t           thread;
+    pthread_t           spawnThread;
+    pthread_attr_t      attrs;
+    struct sched_param  priParam;
+    int                 retc;
+
+    Board_init();
+
+    /* Start the SimpleLink spawn thread before anything calls sl_Start() */
+    pthread_attr_init(&attrs);
+    priParam.sched_priority = SPAWN_TASK_PRIORITY;
+    retc = pthread_attr_setschedparam(&attrs, &priParam);
+    retc |= pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+    retc |= pthread_attr_setstacksize(&attrs, SPAWN_STACK_SIZE);
+    if (retc != 0) {
+        /* failed to set attributes */
+        while (1) {}
+    }
+
+    retc = pthread_create(&spawnThread, &attrs, sl_Task, NULL);
+    if (retc != 0) {
+        /* pthread_create() failed */
+        while (1) {}
+    }
+
+    /* Initialize the attributes structure with default values */
+    pthread_attr_init(&attrs);
+
+    /* Set priority, detach state, and stack size attributes */
+    priParam.sched_priority = 1;
+    retc = pthread_attr_setschedparam(&attrs, &priParam);
+    retc |= pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+    retc |= pthread_attr_setstacksize(&attrs, THREADSTACKSIZE);
+    if (retc != 0) {
+        /* failed to set attributes */
+        while (1) {}
+    }
+
+    retc = pthread_create(&thread, &attrs, mainThread, NULL);
+    if (retc != 0) {
+        /* pthread_create() failed */
+        while (1) {}
+    }
+
+    /* Start the FreeRTOS scheduler */
+    vTaskStartScheduler();
+
+    return (0);
+}
+
+/*
+ *  ======== vApplicationMallocFailedHook ========
+ *  Called if a call to pvPortMalloc() fails. The watchdog resets the board.
+ */
+void vApplicationMallocFailedHook()
+{
+    while (1) {}
+}
+
+/*
+ *  ======== vApplicationStackOverflowHook ========
+ *  Called when a thread overflows its stack, if configCHECK_FOR_STACK_OVERFLOW is set
+ */
+void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName)
+{
+    while (1) {}
+}
+
+#endif /* THERMOSTAT_FREERTOS */
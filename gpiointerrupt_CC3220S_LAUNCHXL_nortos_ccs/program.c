@@ -0,0 +1,161 @@
+/*
+ *  ======== program.c ========
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gpiointerrupt.h"
+#include "program.h"
+#include "timerwheel.h"
+#include "zones.h"
+
+#define MINUTE_MS   60000UL
+#define WEEK_MS     (PROGRAM_WEEK_MIN * MINUTE_MS)
+
+// Heating for a weekday at home mornings and evenings, weekends all day
+static const uint16_t defaultProgram[] = {
+    PROGRAM_ENTRY(DAY_Mon, 6, 30, 21), PROGRAM_ENTRY(DAY_Mon, 8, 30, 17),
+    PROGRAM_ENTRY(DAY_Mon, 17, 0, 21), PROGRAM_ENTRY(DAY_Mon, 22, 30, 16),
+    PROGRAM_ENTRY(DAY_Tue, 6, 30, 21), PROGRAM_ENTRY(DAY_Tue, 8, 30, 17),
+    PROGRAM_ENTRY(DAY_Tue, 17, 0, 21), PROGRAM_ENTRY(DAY_Tue, 22, 30, 16),
+    PROGRAM_ENTRY(DAY_Wed, 6, 30, 21), PROGRAM_ENTRY(DAY_Wed, 8, 30, 17),
+    PROGRAM_ENTRY(DAY_Wed, 17, 0, 21), PROGRAM_ENTRY(DAY_Wed, 22, 30, 16),
+    PROGRAM_ENTRY(DAY_Thu, 6, 30, 21), PROGRAM_ENTRY(DAY_Thu, 8, 30, 17),
+    PROGRAM_ENTRY(DAY_Thu, 17, 0, 21), PROGRAM_ENTRY(DAY_Thu, 22, 30, 16),
+    PROGRAM_ENTRY(DAY_Fri, 6, 30, 21), PROGRAM_ENTRY(DAY_Fri, 8, 30, 17),
+    PROGRAM_ENTRY(DAY_Fri, 17, 0, 21), PROGRAM_ENTRY(DAY_Fri, 23, 30, 16),
+    PROGRAM_ENTRY(DAY_Sat, 8, 0, 21), PROGRAM_ENTRY(DAY_Sat, 23, 30, 16),
+    PROGRAM_ENTRY(DAY_Sun, 8, 0, 21), PROGRAM_ENTRY(DAY_Sun, 22, 30, 16),
+};
+
+uint16_t program[PROGRAM_MAX];
+uint8_t programLength = 0;
+uint8_t programNext = 0;
+bool programRunning = false;
+volatile bool programOverride = false;
+
+static wheelTimer programTimer;
+static uint32_t clockBaseMs;        // wheelTimeMs() when the clock was set...
+static uint32_t clockBaseMin;       // ...to this minute of the week
+
+static void applySetpoint(uint16_t entry)
+{
+    bool changed = false;
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        changed |= zones.setTempCelsius[z] != PROGRAM_TEMP(entry);
+        zones.setTempCelsius[z] = PROGRAM_TEMP(entry);
+    }
+    programOverride = false;
+    // Same as a change from the buttons, so adaptive sampling speeds up for the step
+    if (changed) {
+        sampleSoon();
+    }
+}
+
+// From one transition to the next, wrapping at the end of the week. A program with a
+// single transition repeats it a week later.
+static uint32_t gapMs(uint16_t from, uint16_t to)
+{
+    uint32_t gap = (PROGRAM_MINUTE(to) + PROGRAM_WEEK_MIN - PROGRAM_MINUTE(from)) % PROGRAM_WEEK_MIN;
+
+    return (gap == 0 ? PROGRAM_WEEK_MIN : gap) * MINUTE_MS;
+}
+
+static void transitionDue(wheelTimer *timer)
+{
+    uint16_t entry = program[programNext];
+
+    // Keep time from here, so the clock never rests on a wheelTimeMs() that has wrapped
+    clockBaseMs = wheelTimeMs();
+    clockBaseMin = PROGRAM_MINUTE(entry);
+
+    applySetpoint(entry);
+    programNext = (programNext + 1) % programLength;
+    wheelStart(&programTimer, gapMs(entry, program[programNext]), 0, transitionDue, 0);
+}
+
+// Finds the transition in effect at the current time and sets the timer for the one after.
+// With apply set the transition in effect is applied too. Only run when the clock or the
+// program changes.
+static void programSync(bool apply)
+{
+    uint32_t nowMs;
+    uint32_t dueMs;
+    uint8_t i;
+
+    wheelCancel(&programTimer);
+    if (!programRunning || programLength == 0) {
+        return;
+    }
+
+    nowMs = (clockBaseMin * MINUTE_MS + (wheelTimeMs() - clockBaseMs)) % WEEK_MS;
+    for (i = 0; i < programLength && PROGRAM_MINUTE(program[i]) * MINUTE_MS <= nowMs; ++i) {
+    }
+    programNext = i % programLength;
+
+    // Before the first transition of the week the last one of the week before is in effect
+    if (apply) {
+        applySetpoint(program[(programNext + programLength - 1) % programLength]);
+    }
+
+    dueMs = PROGRAM_MINUTE(program[programNext]) * MINUTE_MS;
+    wheelStart(&programTimer, (dueMs + WEEK_MS - nowMs) % WEEK_MS, 0, transitionDue, 0);
+}
+
+// Loads the default program. The wheel must have been set up (wheelInit()) first.
+void programInit(void)
+{
+    memset(&programTimer, 0, sizeof(programTimer));
+    memcpy(program, defaultProgram, sizeof(defaultProgram));
+    programLength = sizeof(defaultProgram) / sizeof(defaultProgram[0]);
+    programNext = 0;
+    programRunning = false;
+    programOverride = false;
+}
+
+void programSetClock(uint32_t minuteOfWeek)
+{
+    clockBaseMs = wheelTimeMs();
+    clockBaseMin = minuteOfWeek % PROGRAM_WEEK_MIN;
+    programRunning = true;
+    programSync(true);
+}
+
+// Adds a transition, or changes the setpoint of the one already at that time, and applies
+// the program. A setpoint changed by hand holds until the next transition as usual. Returns
+// false if the program is full or the arguments are out of range.
+bool programAdd(uint8_t day, uint8_t hour, uint8_t minute, int16_t temp)
+{
+    uint16_t entry;
+    uint8_t i;
+
+    if (day > DAY_Sun || hour > 23 || minute > 59 || minute % PROGRAM_STEP_MIN != 0 || temp < PROGRAM_TEMP_BASE || temp > PROGRAM_TEMP_MAX) {
+        return false;
+    }
+    entry = PROGRAM_ENTRY(day, hour, minute, temp);
+
+    for (i = 0; i < programLength && PROGRAM_MINUTE(program[i]) < PROGRAM_MINUTE(entry); ++i) {
+    }
+    if (i < programLength && PROGRAM_MINUTE(program[i]) == PROGRAM_MINUTE(entry)) {
+        program[i] = entry;
+    } else {
+        if (programLength == PROGRAM_MAX) {
+            return false;
+        }
+        memmove(&program[i + 1], &program[i], (programLength - i) * sizeof(program[0]));
+        program[i] = entry;
+        ++programLength;
+    }
+    programSync(!programOverride);
+    return true;
+}
+
+// Empties the program. The setpoints stay where they are.
+void programClear(void)
+{
+    programLength = 0;
+    programSync(false);
+}
@@ -0,0 +1,52 @@
+/*
+ *  ======== program.h ========
+ *  Weekly setpoint program.
+ *
+ *  The program is a list of transitions sorted by time of week. Each one is
+ *  packed into 16 bits: the time in PROGRAM_STEP_MIN steps from Monday 00:00
+ *  in the top 10 bits and the setpoint, in whole C above PROGRAM_TEMP_BASE, in
+ *  the low 6. PROGRAM_MAX transitions take 112 bytes.
+ *
+ *  A cursor points at the next transition and a one-shot timing wheel timer
+ *  (timerwheel.h) is set for it. When it fires, every zone takes the new
+ *  setpoint, the cursor moves on one and the timer is set again, so nothing
+ *  is looked at between transitions. The buttons still change the setpoint at
+ *  any time; the change holds until the next transition, even if the program
+ *  is edited in the meantime.
+ *
+ *  There is no clock on the board, so the program does nothing until it is
+ *  told the time with programSetClock() (the "clock" console command). From
+ *  then on it keeps time with the wheel.
+ */
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROGRAM_MAX         56      // 8 a day
+#define PROGRAM_STEP_MIN    15
+#define PROGRAM_TEMP_BASE   5       // Lowest setpoint a transition can hold, in C
+#define PROGRAM_TEMP_MAX    (PROGRAM_TEMP_BASE + 63)
+
+#define PROGRAM_WEEK_MIN    (7UL * 24 * 60)
+
+enum PROGRAM_Days { DAY_Mon, DAY_Tue, DAY_Wed, DAY_Thu, DAY_Fri, DAY_Sat, DAY_Sun };
+
+#define PROGRAM_ENTRY(day, hh, mm, temp) \
+    (uint16_t)(((((day) * 24UL * 60 + (hh) * 60 + (mm)) / PROGRAM_STEP_MIN) << 6) | ((temp) - PROGRAM_TEMP_BASE))
+#define PROGRAM_MINUTE(entry)   (((uint32_t)(entry) >> 6) * PROGRAM_STEP_MIN)
+#define PROGRAM_TEMP(entry)     (int16_t)(((entry) & 0x3F) + PROGRAM_TEMP_BASE)
+
+extern uint16_t program[PROGRAM_MAX];
+extern uint8_t programLength;
+extern uint8_t programNext;             // Transition the timer is set for
+extern bool programRunning;             // The clock has been set
+extern volatile bool programOverride;   // Setpoint changed by hand since the last transition
+
+void programInit(void);
+void programSetClock(uint32_t minuteOfWeek);
+bool programAdd(uint8_t day, uint8_t hour, uint8_t minute, int16_t temp);
+void programClear(void);
+
+#endif /* PROGRAM_H_ */
@@ -0,0 +1,40 @@
+/*
+ *  ======== pt.h ========
+ *  Stackless coroutines (protothreads) for tick functions.
+ *
+ *  A tick function already gets its state passed in and hands the next one
+ *  back, so the state can hold the line to carry on from. A tick function
+ *  written as
+ *
+ *      int TickFct_X(int state) {
+ *          PT_BEGIN(state);
+ *          ...first step...
+ *          PT_YIELD();
+ *          ...second step...
+ *          PT_END();
+ *      }
+ *
+ *  returns after the first step and continues with the second on the next
+ *  tick. The scheduler runs a task with coroutine set again on the next tick
+ *  for as long as its state isn't 0, and goes back to its period once
+ *  PT_END() is reached.
+ *
+ *  Nothing on the stack survives a yield, so anything needed across one has to
+ *  be static or global. A switch statement can't be used across a yield, and
+ *  there can be only one yield per source line.
+ */
+#ifndef PT_H_
+#define PT_H_
+
+#define PT_BEGIN(state)     switch (state) { case 0:
+
+// Give up the rest of this tick and carry on from here on the next one
+#define PT_YIELD()          do { return __LINE__; case __LINE__:; } while (0)
+
+// Yield every tick until cond is true
+#define PT_WAIT_UNTIL(cond) do { case __LINE__: if (!(cond)) { return __LINE__; } } while (0)
+
+// Done. The next run starts from PT_BEGIN() again.
+#define PT_END()            } return 0
+
+#endif /* PT_H_ */
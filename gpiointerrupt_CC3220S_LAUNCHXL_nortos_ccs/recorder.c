@@ -0,0 +1,62 @@
+/*
+ *  ======== recorder.c ========
+ */
+#include <stdint.h>
+
+/* Driver Header files */
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "cycles.h"
+#include "fmt.h"
+#include "hal.h"
+#include "recorder.h"
+
+recEvent recRing[REC_RING_SIZE];
+uint32_t recCount = 0;
+
+// Called from both the button interrupts and the main loop, so the slot is
+// claimed with interrupts off
+void recorderLog(uint8_t type, uint8_t arg, int16_t value)
+{
+    uintptr_t key = HwiP_disable();
+    recEvent *e = &recRing[recCount & (REC_RING_SIZE - 1)];
+    ++recCount;
+
+    e->time = cyclesNow();
+    e->type = type;
+    e->arg = arg;
+    e->value = value;
+    HwiP_restore(key);
+}
+
+// Writes the ring oldest first, one "@R,time,type,arg,value" line per event.
+// This blocks for a couple of seconds at 115200 baud, so it is only meant to
+// be triggered by hand.
+void recorderExport(UART_Handle uart)
+{
+    char line[48];
+    char *p;
+    uint32_t end = recCount;
+    uint32_t i = (end > REC_RING_SIZE) ? end - REC_RING_SIZE : 0;
+
+    p = fmtStr(line, "@R,begin,");
+    p = fmtUint(p, end - i, 0);
+    p = fmtStr(p, "\r\n");
+    halUartWrite(uart, line, p - line);
+
+    for (; i < end; ++i) {
+        const recEvent *e = &recRing[i & (REC_RING_SIZE - 1)];
+        p = fmtStr(line, "@R,");
+        p = fmtUint(p, e->time, 0);
+        p = fmtChar(p, ',');
+        p = fmtUint(p, e->type, 0);
+        p = fmtChar(p, ',');
+        p = fmtUint(p, e->arg, 0);
+        p = fmtChar(p, ',');
+        p = fmtInt(p, e->value, 0);
+        p = fmtStr(p, "\r\n");
+        halUartWrite(uart, line, p - line);
+    }
+
+    halUartWrite(uart, "@R,end\r\n", 8);
+}
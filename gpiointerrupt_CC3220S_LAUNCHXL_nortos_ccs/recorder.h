@@ -0,0 +1,38 @@
+/*
+ *  ======== recorder.h ========
+ *  Flight recorder for the thermostat's inputs.
+ *
+ *  Every sensor sample, button interrupt and serviced timer tick is logged to a
+ *  RAM ring with a cycle counter timestamp. recorderExport() dumps the ring over
+ *  UART as text lines which host/replay.c feeds back through the same tick
+ *  functions to reproduce a field run.
+ */
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+#include <stdint.h>
+
+#include <ti/drivers/UART.h>
+
+// Number of events kept. Must be a power of two. At ten ticks a second plus the
+// sensor reads this holds a little over a minute of history.
+#ifndef REC_RING_SIZE
+#define REC_RING_SIZE 1024
+#endif
+
+enum REC_Types { REC_Tick, REC_UpBtn, REC_DownBtn, REC_Temp, REC_TempFail, REC_Setpoint, REC_Deadline };
+
+typedef struct recEvent {
+    uint32_t time;      // cyclesNow() when the event was logged
+    uint8_t type;       // REC_Types
+    uint8_t arg;        // Sensor, zone or task index
+    int16_t value;      // Raw sensor register, I2C status, setpoint or ms past a deadline
+} recEvent;
+
+extern recEvent recRing[REC_RING_SIZE];
+extern uint32_t recCount;   // Total events logged since boot
+
+void recorderLog(uint8_t type, uint8_t arg, int16_t value);
+void recorderExport(UART_Handle uart);
+
+#endif /* RECORDER_H_ */
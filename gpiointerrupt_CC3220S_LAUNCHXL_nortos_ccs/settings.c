@@ -0,0 +1,229 @@
+/*
+ *  ======== settings.c ========
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <ti/drivers/net/wifi/simplelink.h>
+
+#include "control.h"
+#include "gpiointerrupt.h"
+#include "program.h"
+#include "settings.h"
+#include "timerwheel.h"
+#include "zones.h"
+
+bool settingsLoaded = false;
+unsigned long settingsWrites = 0;
+unsigned long settingsWriteFailures = 0;
+
+static bool fsReady = false;            // The network processor is up, so the file system is there
+static settingsRecord loaded;           // Read at boot, applied by settingsInit()
+static settingsRecord stored;           // What the file holds now
+static settingsRecord pending;          // Live values at the last poll
+static uint32_t quietMs;                // Since pending last changed
+static wheelTimer pollTimer;
+
+static uint16_t fletcher16(const uint8_t *data, uint16_t length)
+{
+    uint16_t a = 0;
+    uint16_t b = 0;
+
+    while (length--) {
+        a = (a + *data++) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+// Fills r from the live values. Padding is zeroed so records compare and check with memcmp().
+static void capture(settingsRecord *r)
+{
+    uint8_t z;
+    uint8_t i;
+
+    memset(r, 0, sizeof(*r));
+    r->magic = SETTINGS_MAGIC;
+    r->version = SETTINGS_VERSION;
+    r->size = sizeof(*r);
+    for (z = 0; z < NUM_ZONES; ++z) {
+        r->setTempCelsius[z] = zones.setTempCelsius[z];
+        r->deadband[z] = control.deadband[z];
+        r->hysteresis[z] = zones.hysteresis[z];
+        r->controlMode[z] = control.mode[z];
+    }
+    for (i = 0; i < numTasks; ++i) {
+        r->taskPeriod[i] = (uint16_t)tasks[i].period;
+        r->taskEnabled |= (uint8_t)(tasks[i].enabled << i);
+    }
+    // Adaptive sampling moves this period on its own, which is not a setting
+    if (adaptiveSampling) {
+        r->taskPeriod[TASK_SetTemp] = 0;
+    }
+    r->reportMode = reportMode;
+    r->adaptiveSampling = adaptiveSampling;
+    r->programLength = programLength;
+    memcpy(r->program, program, sizeof(r->program));
+    r->check = fletcher16((const uint8_t *)r, offsetof(settingsRecord, check));
+}
+
+static bool valid(const settingsRecord *r)
+{
+    return r->magic == SETTINGS_MAGIC && r->version == SETTINGS_VERSION && r->size == sizeof(*r)
+        && r->check == fletcher16((const uint8_t *)r, offsetof(settingsRecord, check))
+        && r->programLength <= PROGRAM_MAX;
+}
+
+static void apply(const settingsRecord *r)
+{
+    uint8_t z;
+    uint8_t i;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        zones.setTempCelsius[z] = r->setTempCelsius[z];
+        zones.hysteresis[z] = r->hysteresis[z];
+        if (r->controlMode[z] < CTRL_NUM_MODES) {
+            controlSetMode(z, r->controlMode[z]);
+        }
+        control.deadband[z] = r->deadband[z];
+    }
+    for (i = 0; i < numTasks; ++i) {
+        if (r->taskPeriod[i] != 0) {
+            taskSetPeriod(i, r->taskPeriod[i]);
+        }
+        taskEnable(i, (r->taskEnabled >> i) & 1);
+    }
+    reportMode = r->reportMode;
+    adaptiveSampling = r->adaptiveSampling;
+    programLength = r->programLength;
+    memcpy(program, r->program, sizeof(program));
+}
+
+// Replaces the file with r. Takes a few milliseconds of flash time, so it only happens
+// from the poll once the values have settled.
+static bool writeRecord(const settingsRecord *r)
+{
+    _i32 file;
+    _i32 written;
+    _u32 token = 0;
+
+    file = sl_FsOpen((const _u8 *)SETTINGS_FILE,
+                     SL_FS_CREATE | SL_FS_OVERWRITE | SL_FS_CREATE_FAILSAFE | SL_FS_CREATE_MAX_SIZE(sizeof(*r)),
+                     &token);
+    if (file < 0) {
+        return false;
+    }
+    written = sl_FsWrite(file, 0, (_u8 *)r, sizeof(*r));
+    // A failed close throws the new copy away and keeps the old one
+    if (sl_FsClose(file, NULL, NULL, 0) < 0 || written != sizeof(*r)) {
+        return false;
+    }
+    return true;
+}
+
+static void pollDue(wheelTimer *timer)
+{
+    settingsRecord now;
+
+    capture(&now);
+    if (memcmp(&now, &pending, sizeof(now)) != 0) {
+        pending = now;
+        quietMs = 0;
+        return;
+    }
+    if (quietMs < SETTINGS_QUIET_MS) {
+        quietMs += SETTINGS_POLL_MS;
+        return;
+    }
+    if (memcmp(&pending, &stored, sizeof(pending)) == 0 || !fsReady) {
+        return;
+    }
+
+    if (writeRecord(&pending)) {
+        stored = pending;
+        settingsWrites++;
+    } else {
+        // Try again after another quiet spell rather than every poll
+        settingsWriteFailures++;
+        quietMs = 0;
+    }
+}
+
+// Starts the network processor, which owns the file system, and reads the record. Call
+// once at boot, before initTasks().
+void settingsLoad(void)
+{
+    _i32 file;
+    _u32 token = 0;
+
+    fsReady = sl_Start(NULL, NULL, NULL) >= 0;
+    if (!fsReady) {
+        return;
+    }
+
+    file = sl_FsOpen((const _u8 *)SETTINGS_FILE, SL_FS_READ, &token);
+    if (file < 0) {
+        return;                         // Nothing saved yet
+    }
+    settingsLoaded = sl_FsRead(file, 0, (_u8 *)&loaded, sizeof(loaded)) == sizeof(loaded) && valid(&loaded);
+    sl_FsClose(file, NULL, NULL, 0);
+}
+
+// Called at the end of initTasks(). Puts the loaded record into effect and starts watching
+// for changes; the values in effect now count as saved.
+void settingsInit(void)
+{
+    if (settingsLoaded) {
+        apply(&loaded);
+    }
+    capture(&stored);
+    pending = stored;
+    quietMs = 0;
+    memset(&pollTimer, 0, sizeof(pollTimer));
+    wheelStart(&pollTimer, SETTINGS_POLL_MS, SETTINGS_POLL_MS, pollDue, 0);
+}
+
+#if !defined(HOST_BUILD)
+/*
+ *  ======== SimpleLink events ========
+ *  The host driver calls these for the network processor's asynchronous events.
+ *  Only the file system is used, so there is nothing to do except give up on it
+ *  after a fatal error.
+ */
+void SimpleLinkFatalErrorEventHandler(SlDeviceFatal_t *slFatalErrorEvent)
+{
+    fsReady = false;
+}
+
+void SimpleLinkGeneralEventHandler(SlDeviceEvent_t *pDevEvent)
+{
+}
+
+void SimpleLinkWlanEventHandler(SlWlanEvent_t *pWlanEvent)
+{
+}
+
+void SimpleLinkNetAppEventHandler(SlNetAppEvent_t *pNetAppEvent)
+{
+}
+
+void SimpleLinkHttpServerEventHandler(SlNetAppHttpServerEvent_t *pHttpEvent,
+                                      SlNetAppHttpServerResponse_t *pHttpResponse)
+{
+}
+
+void SimpleLinkSockEventHandler(SlSockEvent_t *pSock)
+{
+}
+
+void SimpleLinkNetAppRequestEventHandler(SlNetAppRequest_t *pNetAppRequest,
+                                         SlNetAppResponse_t *pNetAppResponse)
+{
+}
+
+void SimpleLinkNetAppRequestMemFreeEventHandler(uint8_t *buffer)
+{
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+ *  ======== settings.h ========
+ *  Setpoints and tunables kept across resets in the SimpleLink file system.
+ *
+ *  Everything the buttons and the console can change goes into one record:
+ *  the zone setpoints, hysteresis and control laws, the task periods, the
+ *  report mode and the setpoint program. The record starts with a magic
+ *  number, a version and its size, and ends with a Fletcher-16 checksum; a
+ *  record from another build or a torn write is ignored and the compile-time
+ *  values are kept. Bump SETTINGS_VERSION whenever the layout changes.
+ *
+ *  settingsLoad() reads the record once at boot, before the tasks start, and
+ *  settingsInit() (from initTasks()) puts it into effect before the first
+ *  control pass. After that a timing wheel timer compares the live values with
+ *  the record every SETTINGS_POLL_MS. A change is only written once nothing has
+ *  changed for SETTINGS_QUIET_MS, so a run of button presses or console
+ *  commands costs one write. The file is created fail-safe, so a reset in the
+ *  middle of a write leaves the previous record readable.
+ */
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gpiointerrupt.h"
+#include "program.h"
+#include "zones.h"
+
+#define SETTINGS_FILE       "thermostat.cfg"
+#define SETTINGS_MAGIC      0x5354      // "ST"
+#define SETTINGS_VERSION    1
+
+#define SETTINGS_POLL_MS    1000
+#ifndef SETTINGS_QUIET_MS
+#define SETTINGS_QUIET_MS   10000
+#endif
+
+typedef struct settingsRecord {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t size;                           // sizeof(settingsRecord), catches a NUM_ZONES change
+    int16_t setTempCelsius[NUM_ZONES];
+    int16_t deadband[NUM_ZONES];            // control.deadband, 1/128 C
+    uint8_t hysteresis[NUM_ZONES];
+    uint8_t controlMode[NUM_ZONES];         // CTRL_Modes
+    uint16_t taskPeriod[NUM_TASKS];         // ms up to TASK_PERIOD_MAX, 0 leaves the compiled-in period
+    uint8_t taskEnabled;                    // Bit per task
+    uint8_t reportMode;                     // REPORT_Modes
+    uint8_t adaptiveSampling;
+    uint8_t programLength;
+    uint16_t program[PROGRAM_MAX];          // See program.h
+    uint16_t check;                         // Fletcher-16 of everything before it
+} settingsRecord;
+
+extern bool settingsLoaded;                 // A good record was read at boot
+extern unsigned long settingsWrites;
+extern unsigned long settingsWriteFailures;
+
+void settingsLoad(void);
+void settingsInit(void);
+
+#endif /* SETTINGS_H_ */
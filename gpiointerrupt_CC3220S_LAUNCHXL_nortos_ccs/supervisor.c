@@ -0,0 +1,141 @@
+/*
+ *  ======== supervisor.c ========
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Driver Header files */
+#include <ti/drivers/Watchdog.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "fmt.h"
+#include "gpiointerrupt.h"
+#include "hal.h"
+#include "recorder.h"
+#include "supervisor.h"
+#include "trace.h"
+#include "zones.h"
+
+// A base tick of SCHED_MAX_TICK has to feed the watchdog before it runs out
+#if SCHED_MAX_TICK * SUPERVISOR_FEED_MARGIN > SUPERVISOR_WATCHDOG_MS
+#error "SUPERVISOR_WATCHDOG_MS is too short for SCHED_MAX_TICK"
+#endif
+
+volatile uint8_t supervisorRunning = SUPERVISOR_NO_TASK;
+volatile uint8_t supervisorMissed = SUPERVISOR_NO_TASK;
+
+static Watchdog_Handle watchdog;
+
+// Milliseconds counted by the timer interrupt, which keeps going when the main loop doesn't
+static volatile unsigned long supervisorNow = 0;
+static volatile unsigned long checkIn[NUM_TASKS];
+static volatile uint8_t suspended = 0;
+
+// First watchdog timeout. Runs in interrupt context with the board about to reset,
+// so the report is written with polling.
+static void supervisorExpired(uintptr_t handle)
+{
+    char line[32];
+    char *p;
+    uint8_t task = supervisorMissed;
+
+    traceEvent(TRACE_Isr, TRACE_IrqWatchdog, task);
+    zonesFailSafe();
+
+    // No missed deadline means the timer interrupt itself stopped. Blame whatever was running.
+    if (task == SUPERVISOR_NO_TASK) {
+        task = supervisorRunning;
+        recorderLog(REC_Deadline, task, 0);
+    }
+
+    if (uart != NULL) {
+        p = fmtStr(line, "#deadline task=");
+        p = (task == SUPERVISOR_NO_TASK) ? fmtChar(p, '-') : fmtUint(p, task, 0);
+        p = fmtStr(p, " reset\r\n");
+        halUartWritePolling(uart, line, p - line);
+    }
+    // Not cleared, so the second timeout resets the board
+}
+
+// Call before anything that can get stuck in an error trap
+void supervisorInit(void)
+{
+    Watchdog_Params params;
+    uint32_t reload;
+
+    Watchdog_init();
+    Watchdog_Params_init(&params);
+    params.callbackFxn = supervisorExpired;
+    params.resetMode = Watchdog_RESET_ON;
+    params.debugStallMode = Watchdog_DEBUG_STALL_ON;   // Don't reset while halted in the debugger
+
+    watchdog = Watchdog_open(CONFIG_WATCHDOG_0, &params);
+    if (watchdog == NULL) {
+        /* Failed to open the watchdog */
+        while (1) {}
+    }
+    // The period is set here rather than in gpiointerrupt.syscfg, so it is checked against SCHED_MAX_TICK
+    reload = Watchdog_convertMsToTicks(watchdog, SUPERVISOR_WATCHDOG_MS);
+    if (reload == 0 || Watchdog_setReload(watchdog, reload) != Watchdog_STATUS_SUCCESS) {
+        /* Failed to set the watchdog period */
+        while (1) {}
+    }
+}
+
+// Starts a task's deadline over. runTasks() calls it when a tick function returns,
+// and it is also called when a task is enabled or its period changes.
+void supervisorCheckIn(uint8_t id)
+{
+    checkIn[id] = supervisorNow;
+}
+
+// Called from the timer interrupt every base tick
+void supervisorTick(unsigned long ms)
+{
+    unsigned long late;
+    uint8_t i;
+
+    supervisorNow += ms;
+    if (supervisorMissed != SUPERVISOR_NO_TASK) {
+        return;                     // Already failed, let the watchdog run out
+    }
+    if (suspended) {
+        Watchdog_clear(watchdog);
+        return;
+    }
+
+    for (i = 0; i < numTasks; ++i) {
+        if (!tasks[i].enabled) {
+            continue;
+        }
+        late = supervisorNow - checkIn[i];
+        if (late > SUPERVISOR_DEADLINE_PERIODS * tasks[i].period) {
+            // Every task stops checking in when one of them hangs, so the one
+            // that's running is the real culprit rather than the first one noticed
+            supervisorMissed = (supervisorRunning != SUPERVISOR_NO_TASK) ? supervisorRunning : i;
+            zonesFailSafe();
+            recorderLog(REC_Deadline, supervisorMissed, (late < INT16_MAX) ? late : INT16_MAX);
+            return;
+        }
+    }
+
+    Watchdog_clear(watchdog);
+}
+
+void supervisorSuspend(void)
+{
+    suspended = 1;
+}
+
+// Every task starts a fresh deadline from here
+void supervisorResume(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < numTasks; ++i) {
+        supervisorCheckIn(i);
+    }
+    suspended = 0;
+}
@@ -0,0 +1,47 @@
+/*
+ *  ======== supervisor.h ========
+ *  Per-task deadline supervision backed by the hardware watchdog.
+ *
+ *  Each task in tasks[] checks in when its tick function returns. The timer
+ *  interrupt feeds the watchdog only while every enabled task has checked in
+ *  within SUPERVISOR_DEADLINE_PERIODS of its own period. When one misses, the
+ *  heaters are switched off for good and the watchdog is left to run out. Its
+ *  first timeout prints the task on the console and its second resets the board.
+ *
+ *  The timer interrupt feeds the watchdog once a base tick, and the tick can be
+ *  changed at run time. supervisorInit() sets the watchdog period from
+ *  SUPERVISOR_WATCHDOG_MS rather than leaving it to gpiointerrupt.syscfg, and
+ *  the build fails unless that is SUPERVISOR_FEED_MARGIN longest ticks or more.
+ *
+ *  A hung I2C read, a while(1) error trap or a lockout of the timer interrupt
+ *  all stop the check-ins or the feeding, so they end the same way.
+ */
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+#include <stdint.h>
+
+// A task misses its deadline after this many of its periods without a check-in
+#define SUPERVISOR_DEADLINE_PERIODS 4
+
+// Watchdog timeout in milliseconds, for each of its two stages
+#define SUPERVISOR_WATCHDOG_MS 1000
+
+// The watchdog is fed at least this many times a timeout, at the longest base tick
+#define SUPERVISOR_FEED_MARGIN 2
+
+#define SUPERVISOR_NO_TASK 0xFF
+
+extern volatile uint8_t supervisorRunning;  // Task whose tick function is running
+extern volatile uint8_t supervisorMissed;   // Task blamed for the missed deadline
+
+void supervisorInit(void);
+void supervisorCheckIn(uint8_t id);
+void supervisorTick(unsigned long ms);
+
+// Deadlines aren't checked between these, for long blocking jobs such as a
+// flight recorder dump. The watchdog is still fed.
+void supervisorSuspend(void);
+void supervisorResume(void);
+
+#endif /* SUPERVISOR_H_ */
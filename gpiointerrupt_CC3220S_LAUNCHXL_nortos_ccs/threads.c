@@ -0,0 +1,234 @@
+/*
+ *  ======== threads.c ========
+ */
+#if defined(THERMOSTAT_FREERTOS)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* POSIX Header files */
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "command.h"
+#include "gpiointerrupt.h"
+#include "recorder.h"
+#include "supervisor.h"
+#include "threads.h"
+#include "timerwheel.h"
+#include "trace.h"
+
+static pthread_mutex_t consoleLock;
+static pthread_mutex_t zoneLock;
+
+static bool usesConsole(unsigned char id)
+{
+    return id == TASK_SetTemp || id == TASK_Output || id == TASK_Stats;
+}
+
+static void addMs(struct timespec *t, unsigned long ms)
+{
+    t->tv_sec += ms / 1000;
+    t->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        ++t->tv_sec;
+    }
+}
+
+// Microseconds since t, or 0 if t is still to come
+static unsigned long usSince(const struct timespec *t)
+{
+    struct timespec now;
+    long long us;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    us = (long long)(now.tv_sec - t->tv_sec) * 1000000 + (now.tv_nsec - t->tv_nsec) / 1000;
+    return (us > 0) ? (unsigned long)us : 0;
+}
+
+static void *taskThread(void *arg0)
+{
+    unsigned char id = (unsigned char)(uintptr_t)arg0;
+    struct timespec release;
+
+    // The first release follows initTasks(): a task whose elapsed time already equals
+    // its period is due straight away
+    clock_gettime(CLOCK_MONOTONIC, &release);
+    addMs(&release, tasks[id].period - tasks[id].elapsedTime);
+
+    while (1) {
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release, NULL);
+
+        if (tasks[id].enabled) {
+            if (usesConsole(id)) {
+                pthread_mutex_lock(&consoleLock);
+            }
+            // Every task reads or writes the zone table: SetTemp the readings, the buttons
+            // the setpoints and override, CheckTemp the heaters, Output and Stats report them
+            pthread_mutex_lock(&zoneLock);
+            // Latency includes any wait for the locks
+            if (!taskInProgress(id)) {
+                taskNoteLatency(id, usSince(&release));
+            }
+            taskRun(id);
+            pthread_mutex_unlock(&zoneLock);
+            if (usesConsole(id)) {
+                pthread_mutex_unlock(&consoleLock);
+            }
+
+            // A coroutine that yielded carries on one base tick from now
+            if (taskInProgress(id)) {
+                clock_gettime(CLOCK_MONOTONIC, &release);
+                addMs(&release, timerPeriod);
+                continue;
+            }
+        }
+
+        // A task more than a period behind starts again from now instead of running
+        // back to back to catch up
+        addMs(&release, tasks[id].period);
+        if (usSince(&release) > tasks[id].period * 1000) {
+            clock_gettime(CLOCK_MONOTONIC, &release);
+        }
+    }
+
+    return (NULL);
+}
+
+// Console commands and the two button flight recorder dump, which the NoRTOS main loop does
+static void *consoleThread(void *arg0)
+{
+    struct timespec release;
+    bool exported = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &release);
+    while (1) {
+        addMs(&release, CONSOLE_POLL_MS);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release, NULL);
+
+        pthread_mutex_lock(&consoleLock);
+        // The button threads take a while to clear the flags, so dump once per press
+        if (upBtnPressed && downBtnPressed) {
+            if (!exported) {
+                supervisorSuspend();
+                // The trace goes first, before the recorder dump fills it with UART writes
+                traceExport(uart);
+                recorderExport(uart);
+                supervisorResume();
+            }
+            exported = true;
+        } else {
+            exported = false;
+        }
+        // Commands change control laws, the program and the timers behind them
+        pthread_mutex_lock(&zoneLock);
+        commandPoll();
+        pthread_mutex_unlock(&zoneLock);
+        pthread_mutex_unlock(&consoleLock);
+    }
+
+    return (NULL);
+}
+
+// The software timers: heater PWM edges, program transitions and the settings poll. None
+// of their callbacks use the console.
+static void *timerThread(void *arg0)
+{
+    struct timespec release;
+
+    clock_gettime(CLOCK_MONOTONIC, &release);
+    while (1) {
+        addMs(&release, WHEEL_TICK_MS);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release, NULL);
+
+        pthread_mutex_lock(&zoneLock);
+        wheelAdvance(WHEEL_TICK_MS);
+        pthread_mutex_unlock(&zoneLock);
+    }
+
+    return (NULL);
+}
+
+static void startThread(void *(*fxn)(void *), void *arg, int priority, size_t stackSize)
+{
+    pthread_t thread;
+    pthread_attr_t attrs;
+    struct sched_param priParam;
+    int status;
+
+#if defined(HOST_BUILD)
+    // glibc won't make a stack smaller than PTHREAD_STACK_MIN (16 KB), so host runs say
+    // nothing about whether the sizes in threads.h are enough on the board
+    if (stackSize < PTHREAD_STACK_MIN) {
+        stackSize = PTHREAD_STACK_MIN;
+    }
+#endif
+
+    pthread_attr_init(&attrs);
+    priParam.sched_priority = priority;
+    status = pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+    status |= pthread_attr_setstacksize(&attrs, stackSize);
+#if !defined(HOST_BUILD)
+    status |= pthread_attr_setschedparam(&attrs, &priParam);
+#endif
+    if (status != 0) {
+        /* Failed to set the thread attributes */
+        while (1) {}
+    }
+
+#if defined(HOST_BUILD)
+    // Linux only honours the priority for real-time threads, and takes it only once the
+    // policy is SCHED_FIFO. Creating those needs privileges; without them (EPERM) the
+    // thread still runs, just under the normal time sharing policy.
+    if (pthread_attr_setinheritsched(&attrs, PTHREAD_EXPLICIT_SCHED) == 0
+        && pthread_attr_setschedpolicy(&attrs, SCHED_FIFO) == 0
+        && pthread_attr_setschedparam(&attrs, &priParam) == 0) {
+        status = pthread_create(&thread, &attrs, fxn, arg);
+        if (status == 0) {
+            return;
+        }
+        if (status != EPERM) {
+            /* Failed to create the thread */
+            while (1) {}
+        }
+    }
+    if (pthread_attr_setinheritsched(&attrs, PTHREAD_INHERIT_SCHED) != 0) {
+        /* Failed to set the thread attributes */
+        while (1) {}
+    }
+#endif
+
+    if (pthread_create(&thread, &attrs, fxn, arg) != 0) {
+        /* Failed to create the thread */
+        while (1) {}
+    }
+}
+
+// Called by mainThread() in place of the NoRTOS loop, once everything is initialized
+void threadsStart(void)
+{
+    pthread_mutexattr_t attrs;
+    unsigned char i;
+
+    pthread_mutex_init(&consoleLock, NULL);
+    // CheckTemp and the timer thread wait on this one, so a less urgent holder is lifted to them
+    pthread_mutexattr_init(&attrs);
+    if (pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT) != 0
+        || pthread_mutex_init(&zoneLock, &attrs) != 0) {
+        /* Failed to create the mutex */
+        while (1) {}
+    }
+    for (i = 0; i < numTasks; ++i) {
+        startThread(taskThread, (void *)(uintptr_t)i, THREAD_PRIORITY_TOP - tasks[i].priority,
+                    THREAD_STACK_SIZE);
+    }
+    startThread(timerThread, NULL, THREAD_PRIORITY_TOP, TIMER_STACK_SIZE);
+    startThread(consoleThread, NULL, 1, THREAD_STACK_SIZE);
+}
+
+#endif /* THERMOSTAT_FREERTOS */
@@ -0,0 +1,51 @@
+/*
+ *  ======== threads.h ========
+ *  FreeRTOS build of the scheduler, used when THERMOSTAT_FREERTOS is defined.
+ *
+ *  Every tasks[] entry gets a thread of its own that sleeps until the task is
+ *  due, so the buttons and the heater control never wait behind an I2C read
+ *  or a UART write. Those calls block on a driver semaphore under FreeRTOS and
+ *  give the CPU to the other threads. The threads use the POSIX API that the
+ *  SDK layers over FreeRTOS, so the same code runs on Linux pthreads in the
+ *  host tools.
+ *
+ *  SetTemp, Output, Stats and the console share output[] and the UART, so they
+ *  take turns through one mutex. A second one, the zone lock, covers the zone
+ *  readings, setpoints and heaters, the control laws and the software timers:
+ *  every task, the console commands and the timer thread hold it while they
+ *  run. The timer thread drives timerwheel.c at the top priority, so a
+ *  heater PWM edge waits at most for the slice that holds the zone lock, whose
+ *  thread inherits the timer thread's priority meanwhile. When both locks are
+ *  needed the console lock is taken first. Task periods
+ *  and enables set at run time are picked up at each thread's next release.
+ *  taskSetPhase() only applies to the NoRTOS scheduler.
+ */
+#ifndef THREADS_H_
+#define THREADS_H_
+
+// Stack per thread in bytes, sized for each thread's deepest call path. The application
+// frames on those paths (gcc -fcallgraph-info=su) come to about 420 bytes for SetTemp's
+// read with bus recovery (readTemp > transferTemp > recorderLog, with I2C_open() and
+// I2C_transfer() below) and 350 for the timer thread's settings save (wheelAdvance >
+// pollDue > capture, then the SimpleLink sl_Fs calls). The rest covers the driver calls
+// underneath and the exception frame with the FPU registers. The timer thread's share
+// is mostly the SimpleLink host driver, hence the bigger stack. The console thread's
+// deepest path, a prog command, is shallower than SetTemp's.
+#define THREAD_STACK_SIZE 1536
+#define TIMER_STACK_SIZE 3072
+
+// Thread priority of a priority 0 task. Less urgent tasks count down from here
+// and the console thread runs at 1, just above the idle task. The timer thread
+// shares the top priority with the buttons. The SimpleLink spawn thread that
+// main_freertos.c starts runs above all of them.
+#define THREAD_PRIORITY_TOP 5
+
+// How often the console thread looks for a command or a recorder dump request
+#define CONSOLE_POLL_MS 50
+
+// How often the timer thread advances the software timers, which is how late a timer can fire
+#define WHEEL_TICK_MS 50
+
+void threadsStart(void);
+
+#endif /* THREADS_H_ */
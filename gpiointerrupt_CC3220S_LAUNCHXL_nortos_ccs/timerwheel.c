@@ -0,0 +1,163 @@
+/*
+ *  ======== timerwheel.c ========
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "timerwheel.h"
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+// Each slot is a circular list through a dummy head node
+static wheelTimer wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint32_t wheelNow = 0;           // Step the finest wheel is on
+static uint32_t wheelRemainderMs = 0;   // Time passed that doesn't make up a whole step yet
+
+void wheelInit(void)
+{
+    uint8_t level;
+    uint8_t slot;
+
+    for (level = 0; level < WHEEL_LEVELS; ++level) {
+        for (slot = 0; slot < WHEEL_SLOTS; ++slot) {
+            wheel[level][slot].next = &wheel[level][slot];
+            wheel[level][slot].prev = &wheel[level][slot];
+        }
+    }
+    wheelNow = 0;
+    wheelRemainderMs = 0;
+}
+
+static void unlink(wheelTimer *timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+static void linkTail(wheelTimer *head, wheelTimer *timer)
+{
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+// The slot is picked by how far off the timer is: the finest wheel that reaches it
+static void place(wheelTimer *timer)
+{
+    uint32_t expires = timer->expires;
+    uint32_t delta = expires - wheelNow;
+    wheelTimer *head;
+
+    if ((int32_t)delta < 0) {
+        head = &wheel[0][wheelNow & WHEEL_MASK];            // Overdue, runs on this step
+    } else if (delta < (1UL << WHEEL_BITS)) {
+        head = &wheel[0][expires & WHEEL_MASK];
+    } else if (delta < (1UL << (2 * WHEEL_BITS))) {
+        head = &wheel[1][(expires >> WHEEL_BITS) & WHEEL_MASK];
+    } else {
+        if (delta >= (1UL << (3 * WHEEL_BITS))) {
+            expires = wheelNow + (1UL << (3 * WHEEL_BITS)) - 1;   // Park in the last slot
+        }
+        head = &wheel[2][(expires >> (2 * WHEEL_BITS)) & WHEEL_MASK];
+    }
+    linkTail(head, timer);
+}
+
+// Starts or restarts a timer. Delays are rounded up to whole steps, and a delay of 0
+// runs the timer on the next step. A periodMs of 0 makes a one-shot timer.
+void wheelStart(wheelTimer *timer, uint32_t delayMs, uint32_t periodMs, wheelCallback callback, uintptr_t arg)
+{
+    uint32_t delay = (delayMs + WHEEL_RESOLUTION_MS - 1) / WHEEL_RESOLUTION_MS;
+
+    if (wheelActive(timer)) {
+        unlink(timer);
+    }
+    timer->expires = wheelNow + (delay > 0 ? delay : 1);
+    timer->period = (periodMs + WHEEL_RESOLUTION_MS - 1) / WHEEL_RESOLUTION_MS;
+    timer->callback = callback;
+    timer->arg = arg;
+    place(timer);
+}
+
+void wheelCancel(wheelTimer *timer)
+{
+    if (wheelActive(timer)) {
+        unlink(timer);
+    }
+}
+
+bool wheelActive(const wheelTimer *timer)
+{
+    return timer->next != NULL;
+}
+
+// Moves every timer in a coarse slot down to the wheels below it
+static void cascade(uint8_t level, uint8_t slot)
+{
+    wheelTimer *head = &wheel[level][slot];
+    wheelTimer *timer;
+
+    while (head->next != head) {
+        timer = head->next;
+        unlink(timer);
+        place(timer);
+    }
+}
+
+static void step(void)
+{
+    wheelTimer *head = &wheel[0][wheelNow & WHEEL_MASK];
+    wheelTimer pending;
+    wheelTimer *timer;
+
+    // When the finest wheel comes round, the next 64 steps come down from the one above it
+    if ((wheelNow & WHEEL_MASK) == 0) {
+        cascade(1, (wheelNow >> WHEEL_BITS) & WHEEL_MASK);
+        if (((wheelNow >> WHEEL_BITS) & WHEEL_MASK) == 0) {
+            cascade(2, (wheelNow >> (2 * WHEEL_BITS)) & WHEEL_MASK);
+        }
+    }
+
+    // Take the due timers off the slot first so callbacks can restart them, or cancel
+    // any of the others, while the rest are run
+    if (head->next != head) {
+        pending.next = head->next;
+        pending.prev = head->prev;
+        pending.next->prev = &pending;
+        pending.prev->next = &pending;
+        head->next = head;
+        head->prev = head;
+
+        while (pending.next != &pending) {
+            timer = pending.next;
+            unlink(timer);
+            if (timer->period != 0) {
+                timer->expires += timer->period;
+                place(timer);
+            }
+            timer->callback(timer);
+        }
+    }
+
+    ++wheelNow;
+}
+
+// Time the wheel has been turned through since wheelInit(). Wraps after about 49 days.
+uint32_t wheelTimeMs(void)
+{
+    return wheelNow * WHEEL_RESOLUTION_MS + wheelRemainderMs;
+}
+
+// Called once per scheduler tick with the time that has passed
+void wheelAdvance(uint32_t ms)
+{
+    wheelRemainderMs += ms;
+    while (wheelRemainderMs >= WHEEL_RESOLUTION_MS) {
+        wheelRemainderMs -= WHEEL_RESOLUTION_MS;
+        step();
+    }
+}
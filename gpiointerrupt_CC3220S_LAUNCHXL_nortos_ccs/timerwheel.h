@@ -0,0 +1,48 @@
+/*
+ *  ======== timerwheel.h ========
+ *  Software timers on a hierarchical timing wheel, driven by the CONFIG_TIMER_0
+ *  tick through runTasks().
+ *
+ *  Three wheels of 64 slots each cover 10 ms, 640 ms and 40.96 s per slot.
+ *  Starting and cancelling a timer unlinks or links one list node. Each wheel
+ *  step looks at one slot. Every 64 steps the next slot of a coarser wheel is
+ *  spread over the finer one. The cost of a tick therefore depends on the
+ *  timers that are due, not on how many are running.
+ *
+ *  Timers further out than the top wheel reaches (about 43 minutes) park in its
+ *  last slot and get put back until they are due. Callbacks run in the main
+ *  loop and may start or cancel any timer, including their own.
+ */
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Length of one step of the finest wheel, in ms
+#define WHEEL_RESOLUTION_MS 10
+
+#define WHEEL_BITS      6
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_LEVELS    3
+
+typedef struct wheelTimer wheelTimer;
+typedef void (*wheelCallback)(wheelTimer *timer);
+
+struct wheelTimer {
+    wheelTimer *next;           // Slot list links, NULL while the timer isn't running
+    wheelTimer *prev;
+    uint32_t expires;           // Wheel step the timer is due on
+    uint32_t period;            // Steps between repeats, 0 for a one-shot
+    wheelCallback callback;
+    uintptr_t arg;              // For the callback's own use
+};
+
+void wheelInit(void);
+void wheelStart(wheelTimer *timer, uint32_t delayMs, uint32_t periodMs, wheelCallback callback, uintptr_t arg);
+void wheelCancel(wheelTimer *timer);
+bool wheelActive(const wheelTimer *timer);
+void wheelAdvance(uint32_t ms);
+uint32_t wheelTimeMs(void);
+
+#endif /* TIMERWHEEL_H_ */
@@ -0,0 +1,132 @@
+/*
+ *  ======== zones.c ========
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "control.h"
+#include "cycles.h"
+#include "duty.h"
+#include "hal.h"
+#include "zones.h"
+
+zoneTable zones;
+uint8_t selectedZone = 0;
+uint32_t zonePassCycles = 0;
+volatile uint8_t zonesHalted = 0;
+
+void zonesInit(int16_t setTempCelsius, uint8_t hysteresis)
+{
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        zones.setTempCelsius[z] = setTempCelsius;
+        zones.currentTempCelsius[z] = 0;
+        zones.filteredTemp[z] = 0;
+        zones.hysteresis[z] = hysteresis;
+        zones.heaterState[z] = HTR_Off;
+        zones.sensorIndex[z] = z;
+        zones.heaterPin[z] = ZONE_NO_PIN;
+        zones.stale[z] = 0xFF;      // No reading yet
+    }
+
+    // The LaunchPad only has the one red LED to stand in for a heater
+    zones.heaterPin[0] = CONFIG_GPIO_LED_0;
+
+    dutyInit();
+}
+
+// Switches zone z's heater. The GPIO is only written when the state actually changes.
+void zonesSetHeater(uint8_t z, uint8_t state)
+{
+    if (state != zones.heaterState[z]) {
+        zones.heaterState[z] = state;
+        dutyTransition(z, state);
+        if (zones.heaterPin[z] != ZONE_NO_PIN) {
+            halPinWrite(zones.heaterPin[z], state == HTR_On);
+        }
+    }
+}
+
+// One sweep of the heater control over every zone, elapsedMs after the last one, with
+// the control law of each zone (see control.h). A zone without a recent reading fails
+// safe with its heater off.
+void zonesControlPass(uint32_t elapsedMs)
+{
+    uint32_t start = cyclesNow();
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        int16_t current = zones.currentTempCelsius[z];
+        int16_t set = zones.setTempCelsius[z];
+        int16_t band = control.deadband[z] / 2;
+        uint8_t state = zones.heaterState[z];
+
+        if (zones.stale[z] > ZONE_STALE_LIMIT || zonesHalted) {
+            control.output[z] = 0;
+            zonesSetHeater(z, HTR_Off);
+            dutySample(z);
+            continue;
+        }
+
+        switch (control.mode[z]) {
+            case CTRL_PID:
+                // The PWM timers switch the heater, see control.c
+                controlPid(z, elapsedMs);
+                break;
+
+            case CTRL_Deadband:
+                if (zones.filteredTemp[z] < (set << TEMP_FRACTION_BITS) - band) {
+                    state = HTR_On;
+                } else if (zones.filteredTemp[z] > (set << TEMP_FRACTION_BITS) + band) {
+                    state = HTR_Off;
+                }
+                zonesSetHeater(z, state);
+                break;
+
+            default:
+                switch(state) {
+                    case HTR_Off:
+                        if (current < set - zones.hysteresis[z]) {
+                            state = HTR_On;
+                        }
+                        break;
+                    case HTR_On:
+                        if (current >= set + zones.hysteresis[z]) {
+                            state = HTR_Off;
+                        }
+                        break;
+                    default:
+                        state = HTR_Off;
+                        break;
+                }
+                zonesSetHeater(z, state);
+                break;
+        }
+        dutySample(z);
+    }
+
+    zonePassCycles = cyclesNow() - start;
+}
+
+// Switches every heater off and keeps it off until the next reset. Safe to call
+// from interrupt context. The pins are written whatever state the zone thinks
+// it is in, in case the fault left the table and the outputs out of step.
+void zonesFailSafe(void)
+{
+    uint8_t z;
+
+    zonesHalted = 1;
+    for (z = 0; z < NUM_ZONES; ++z) {
+        if (zones.heaterState[z] != HTR_Off) {
+            zones.heaterState[z] = HTR_Off;
+            dutyTransition(z, HTR_Off);
+        }
+        if (zones.heaterPin[z] != ZONE_NO_PIN) {
+            halPinWrite(zones.heaterPin[z], false);
+        }
+    }
+}
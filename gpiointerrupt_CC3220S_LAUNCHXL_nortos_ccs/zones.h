@@ -0,0 +1,51 @@
+/*
+ *  ======== zones.h ========
+ *  Heating zone table for the thermostat.
+ *
+ *  Zone state is kept as a struct of parallel arrays rather than an array of
+ *  structs so a control pass walks each field contiguously and the cost per
+ *  zone stays flat as zones are added.
+ */
+#ifndef ZONES_H_
+#define ZONES_H_
+
+#include <stdint.h>
+
+// Number of zones run by this controller. Each zone reads one of the sensors
+// in sensors[] (gpiointerrupt.c), so there can be at most 3.
+#ifndef NUM_ZONES
+#define NUM_ZONES 1
+#endif
+
+#define ZONE_NO_PIN 0xFF            // Zone has no heater output on this board
+
+// A zone whose reading is older than this many missed samples is treated as having no
+// reading at all and its heater is held off
+#ifndef ZONE_STALE_LIMIT
+#define ZONE_STALE_LIMIT 10
+#endif
+
+enum HTR_States { HTR_Off, HTR_On };
+
+typedef struct zoneTable {
+    int16_t setTempCelsius[NUM_ZONES];
+    int16_t currentTempCelsius[NUM_ZONES];  // filteredTemp rounded to whole degrees
+    int16_t filteredTemp[NUM_ZONES];    // Output of filter.c, in 1/128 C
+    uint8_t hysteresis[NUM_ZONES];  // Degrees either side of the setpoint before switching
+    uint8_t heaterState[NUM_ZONES]; // HTR_States
+    uint8_t sensorIndex[NUM_ZONES]; // Entry in sensors[] read for this zone
+    uint8_t heaterPin[NUM_ZONES];   // GPIO driving the heater, or ZONE_NO_PIN
+    uint8_t stale[NUM_ZONES];       // Samples missed since the last good reading (saturates at 0xFF)
+} zoneTable;
+
+extern zoneTable zones;
+extern uint8_t selectedZone;        // Zone the up/down buttons adjust
+extern uint32_t zonePassCycles;     // Cycles spent in the last control pass
+extern volatile uint8_t zonesHalted; // Set by zonesFailSafe(), holds every heater off
+
+void zonesInit(int16_t setTempCelsius, uint8_t hysteresis);
+void zonesControlPass(uint32_t elapsedMs);
+void zonesSetHeater(uint8_t z, uint8_t state);
+void zonesFailSafe(void);
+
+#endif /* ZONES_H_ */
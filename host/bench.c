@@ -0,0 +1,392 @@
+/*
+ *  ======== bench.c ========
+ *  Host microbenchmarks for the tick functions of both LaunchPad projects and
+ *  for the report formatting path.
+ *
+ *  Each benchmark runs a fixed number of iterations per repetition against the
+ *  stand-in drivers and reports ns/op as the mean, standard deviation and
+ *  minimum over the repetitions. Results are written one JSON object per line
+ *  so they can be collected and compared release over release.
+ *
+ *  Usage: bench [-n iterations] [-r repetitions] [filter]
+ *  Only benchmarks whose name contains filter are run.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "ti_drivers_config.h"
+
+#include "control.h"
+#include "filter.h"
+#include "fmt.h"
+#include "gpiointerrupt.h"
+#include "timerwheel.h"
+#include "trace.h"
+#include "zones.h"
+
+#include "host_drivers.h"
+#include "morse.h"
+
+// uart2echo.c has no header of its own
+extern volatile char input;
+void TickFunction_TrackEntry(void);
+void TickFunction_SetLED(void);
+
+static unsigned long iterations = 1000000;
+static unsigned int repetitions = 10;
+static volatile int sink;
+
+/*
+ *  ======== Benchmark bodies ========
+ *  Each one runs n operations.
+ */
+static void benchSetTemp(unsigned long n)
+{
+    int state = 0;
+    while (n--) {
+        state = TickFct_SetTemp(state);
+    }
+    sink = state;
+}
+
+static void benchUpBtnIdle(unsigned long n)
+{
+    int state = BTN_Off;
+    while (n--) {
+        state = TickFct_CheckUpBtn(state);
+    }
+    sink = state;
+}
+
+static void benchUpBtnPressed(unsigned long n)
+{
+    int state = BTN_Off;
+    while (n--) {
+        upBtnPressed = 1;
+        state = TickFct_CheckUpBtn(state);
+    }
+    zones.setTempCelsius[selectedZone] = DEFAULT_SET_TEMP;
+    sink = state;
+}
+
+static void benchDownBtnPressed(unsigned long n)
+{
+    int state = BTN_Off;
+    while (n--) {
+        downBtnPressed = 1;
+        state = TickFct_CheckDownBtn(state);
+    }
+    zones.setTempCelsius[selectedZone] = DEFAULT_SET_TEMP;
+    sink = state;
+}
+
+static void benchCheckTempSteady(unsigned long n)
+{
+    zones.stale[0] = 0;
+    zones.currentTempCelsius[0] = DEFAULT_SET_TEMP + 2;
+    while (n--) {
+        sink = TickFct_CheckTemp(0);
+    }
+}
+
+// Worst case: the heater switches on every evaluation
+static void benchCheckTempToggle(unsigned long n)
+{
+    zones.stale[0] = 0;
+    while (n--) {
+        zones.currentTempCelsius[0] = (n & 1) ? DEFAULT_SET_TEMP - 5 : DEFAULT_SET_TEMP + 5;
+        sink = TickFct_CheckTemp(0);
+    }
+}
+
+// The other control laws on the same swings as the toggle case
+static void benchCheckTempDeadband(unsigned long n)
+{
+    zones.stale[0] = 0;
+    controlSetMode(0, CTRL_Deadband);
+    while (n--) {
+        zones.filteredTemp[0] = (n & 1) ? (DEFAULT_SET_TEMP - 5) << TEMP_FRACTION_BITS : (DEFAULT_SET_TEMP + 5) << TEMP_FRACTION_BITS;
+        sink = TickFct_CheckTemp(0);
+    }
+    controlSetMode(0, CONTROL_MODE);
+}
+
+static void benchCheckTempPid(unsigned long n)
+{
+    zones.stale[0] = 0;
+    controlSetMode(0, CTRL_PID);
+    while (n--) {
+        zones.filteredTemp[0] = (DEFAULT_SET_TEMP << TEMP_FRACTION_BITS) + (int16_t)(n & 255) - 128;
+        sink = TickFct_CheckTemp(0);
+    }
+    controlSetMode(0, CONTROL_MODE);
+}
+
+static void benchOutput(unsigned long n)
+{
+    while (n--) {
+        sink = TickFct_Output(0);
+    }
+}
+
+// Nothing changes, so every report but the heartbeat is suppressed
+static void benchOutputOnChange(unsigned long n)
+{
+    reportMode = REPORT_OnChange;
+    while (n--) {
+        sink = TickFct_Output(0);
+    }
+    reportMode = REPORT_Periodic;
+}
+
+static void benchRunTasks(unsigned long n)
+{
+    initTasks();
+    while (n--) {
+        runTasks();
+    }
+}
+
+static void benchTraceEvent(unsigned long n)
+{
+    traceInit();
+    while (n--) {
+        traceEvent(TRACE_Isr, TRACE_IrqTimer, (uint16_t)n);
+    }
+}
+
+static void benchFilterUpdate(unsigned long n)
+{
+    int16_t sample = 22 << TEMP_FRACTION_BITS;
+    filterReset(0, sample);
+    while (n--) {
+        sink = filterUpdate(0, sample + (int16_t)(n & 63));
+    }
+}
+
+static void benchEchoFsms(unsigned long n)
+{
+    static const char text[] = "xxONxxOFFxOxOFxON OFF";
+    unsigned long i = 0;
+    while (n--) {
+        input = text[i];
+        i = (i + 1) % (sizeof(text) - 1);
+        TickFunction_TrackEntry();
+        TickFunction_SetLED();
+    }
+}
+
+// One op expands one character of text into LED elements
+static void benchMorseEncode(unsigned long n)
+{
+    static const char text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+    uint8_t elements[MORSE_MAX_ELEMENTS];
+    unsigned long i = 0;
+    while (n--) {
+        sink = morseEncode(text[i], elements);
+        i = (i + 1) % (sizeof(text) - 1);
+    }
+}
+
+/*
+ *  ======== Formatting alternatives for the report line ========
+ */
+static char line[64];
+
+static void benchFormatSnprintf(unsigned long n)
+{
+    while (n--) {
+        sink = snprintf(line, 64, "<%02d,%02d,%d,%04d>\r\n", (int)(n & 31), 22, (int)(n & 1), (int)(n % 10000));
+    }
+}
+
+// The fmt.h chain TickFct_Output uses
+static void benchFormatFmt(unsigned long n)
+{
+    while (n--) {
+        char *p = fmtChar(line, '<');
+        p = fmtInt(p, (int32_t)(n & 31), 2);
+        p = fmtChar(p, ',');
+        p = fmtInt(p, 22, 2);
+        p = fmtChar(p, ',');
+        p = fmtChar(p, '0' + (char)(n & 1));
+        p = fmtChar(p, ',');
+        p = fmtUint(p, (uint32_t)(n % 10000), 4);
+        p = fmtStr(p, ">\r\n");
+        sink = (int)(p - line);
+    }
+}
+
+// Fixed text only, the floor for any DISPLAY call
+static void benchFormatConstant(unsigned long n)
+{
+    static const char text[] = "<22,22,0,0000>\r\n";
+    while (n--) {
+        memcpy(line, text, sizeof(text) - 1);
+        sink = sizeof(text) - 1;
+    }
+}
+
+/*
+ *  ======== Software timers ========
+ *  One op is a 100 ms tick with count periodic timers running, their periods
+ *  spread from 100 ms to 10 s. The linear scan is the tasks[] loop in runTasks().
+ */
+#define MAX_BENCH_TIMERS 500
+
+static wheelTimer benchTimers[MAX_BENCH_TIMERS];
+static struct {
+    unsigned long period;
+    unsigned long elapsedTime;
+} scanTimers[MAX_BENCH_TIMERS];
+
+static unsigned long benchTimerPeriod(unsigned int i)
+{
+    return 100 * (1 + (i * 37) % 100);
+}
+
+static void benchTimerFired(wheelTimer *timer)
+{
+    ++sink;
+}
+
+static void benchWheel(unsigned int count, unsigned long n)
+{
+    unsigned int i;
+
+    wheelInit();
+    for (i = 0; i < count; ++i) {
+        wheelStart(&benchTimers[i], benchTimerPeriod(i), benchTimerPeriod(i), benchTimerFired, i);
+    }
+    while (n--) {
+        wheelAdvance(100);
+    }
+    wheelInit();
+}
+
+static void benchScan(unsigned int count, unsigned long n)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; ++i) {
+        scanTimers[i].period = benchTimerPeriod(i);
+        scanTimers[i].elapsedTime = 0;
+    }
+    while (n--) {
+        for (i = 0; i < count; ++i) {
+            scanTimers[i].elapsedTime += 100;
+            if (scanTimers[i].elapsedTime >= scanTimers[i].period) {
+                scanTimers[i].elapsedTime = 0;
+                ++sink;
+            }
+        }
+    }
+}
+
+static void benchWheel5(unsigned long n) { benchWheel(5, n); }
+static void benchWheel50(unsigned long n) { benchWheel(50, n); }
+static void benchWheel500(unsigned long n) { benchWheel(500, n); }
+static void benchScan5(unsigned long n) { benchScan(5, n); }
+static void benchScan50(unsigned long n) { benchScan(50, n); }
+static void benchScan500(unsigned long n) { benchScan(500, n); }
+
+static const struct {
+    const char *name;
+    void (*run)(unsigned long n);
+} benchmarks[] = {
+    { "TickFct_SetTemp", benchSetTemp },
+    { "TickFct_CheckUpBtn/idle", benchUpBtnIdle },
+    { "TickFct_CheckUpBtn/pressed", benchUpBtnPressed },
+    { "TickFct_CheckDownBtn/pressed", benchDownBtnPressed },
+    { "TickFct_CheckTemp/steady", benchCheckTempSteady },
+    { "TickFct_CheckTemp/toggle", benchCheckTempToggle },
+    { "TickFct_CheckTemp/deadband", benchCheckTempDeadband },
+    { "TickFct_CheckTemp/pid", benchCheckTempPid },
+    { "TickFct_Output", benchOutput },
+    { "TickFct_Output/onchange", benchOutputOnChange },
+    { "filterUpdate", benchFilterUpdate },
+    { "runTasks", benchRunTasks },
+    { "trace/event", benchTraceEvent },
+    { "uart2echo/TrackEntry+SetLED", benchEchoFsms },
+    { "uart2echo/morseEncode", benchMorseEncode },
+    { "format/snprintf", benchFormatSnprintf },
+    { "format/fmt", benchFormatFmt },
+    { "format/constant", benchFormatConstant },
+    { "timers/wheel/5", benchWheel5 },
+    { "timers/wheel/50", benchWheel50 },
+    { "timers/wheel/500", benchWheel500 },
+    { "timers/scan/5", benchScan5 },
+    { "timers/scan/50", benchScan50 },
+    { "timers/scan/500", benchScan500 },
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filter = NULL;
+    size_t b;
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else {
+            filter = argv[i];
+        }
+    }
+    if (iterations == 0 || repetitions == 0) {
+        fprintf(stderr, "bench: iterations and repetitions must be non-zero\n");
+        return 1;
+    }
+
+    // Bring the thermostat up the same way mainThread() does, minus the timer
+    hostUartQuiet = true;
+    GPIO_init();
+    initUART();
+    initI2C();
+    zonesInit(DEFAULT_SET_TEMP, DEFAULT_HYSTERESIS);
+    initTasks();
+
+    for (b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); ++b) {
+        double sum = 0, sumSq = 0, min = 0, mean, stddev;
+        unsigned int r;
+
+        if (filter != NULL && strstr(benchmarks[b].name, filter) == NULL) {
+            continue;
+        }
+
+        benchmarks[b].run(iterations / 10 + 1);     // Warm up caches and branch predictors
+        for (r = 0; r < repetitions; ++r) {
+            double start = now();
+            double perOp;
+            benchmarks[b].run(iterations);
+            perOp = (now() - start) / (double)iterations;
+            sum += perOp;
+            sumSq += perOp * perOp;
+            if (r == 0 || perOp < min) {
+                min = perOp;
+            }
+        }
+        mean = sum / repetitions;
+        stddev = sqrt(fmax(0.0, sumSq / repetitions - mean * mean));
+
+        printf("{\"bench\":\"%s\",\"iterations\":%lu,\"repetitions\":%u,"
+               "\"ns_per_op\":%.3f,\"stddev\":%.3f,\"min\":%.3f}\n",
+               benchmarks[b].name, iterations, repetitions, mean, stddev, min);
+    }
+
+    return 0;
+}
@@ -0,0 +1,628 @@
+/*
+ *  ======== host_drivers.c ========
+ *  Host stand-ins for the TI drivers used by the LaunchPad projects.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/UART.h>
+#include <ti/drivers/UART2.h>
+#include <ti/drivers/Watchdog.h>
+#include <ti/drivers/net/wifi/simplelink.h>
+
+#include "cycles.h"
+#include "host_drivers.h"
+#include "i2cbusclear.h"
+
+/*
+ *  ======== Board ========
+ */
+void Board_init(void)
+{
+}
+
+bool hostClockSimulated = false;
+volatile uint32_t hostClockNs = 0;
+
+// Stands in for the time a driver call spends waiting on the hardware
+static void hostWait(unsigned long us)
+{
+    struct timespec t;
+
+    if (hostClockSimulated) {
+        hostClockNs += (uint32_t)us * 1000;
+    } else if (us != 0) {
+        t.tv_sec = us / 1000000;
+        t.tv_nsec = (long)(us % 1000000) * 1000;
+        nanosleep(&t, NULL);
+    }
+}
+
+/*
+ *  ======== Faults ========
+ *  Each driver draws from a generator of its own, so the timer thread of the
+ *  soak tool doesn't change what the I2C and UART calls see.
+ */
+static uint32_t i2cFaultRng = 1;
+static uint32_t uartFaultRng = 2;
+static uint32_t timerFaultRng = 3;
+
+// xorshift32
+static uint32_t faultNext(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static bool faultHit(uint32_t *state, unsigned long permille)
+{
+    return permille != 0 && faultNext(state) % 1000 < permille;
+}
+
+void hostFaultSeed(uint32_t seed)
+{
+    i2cFaultRng = seed * 3 + 1;
+    uartFaultRng = seed * 5 + 2;
+    timerFaultRng = seed * 7 + 3;
+}
+
+/*
+ *  ======== GPIO ========
+ */
+unsigned int hostGpioLevel[HOST_GPIO_COUNT];
+unsigned long hostGpioWrites = 0;
+static GPIO_CallbackFxn gpioCallbacks[HOST_GPIO_COUNT];
+
+void GPIO_init(void)
+{
+    memset(hostGpioLevel, 0, sizeof(hostGpioLevel));
+    memset(gpioCallbacks, 0, sizeof(gpioCallbacks));
+}
+
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig)
+{
+    if (index < HOST_GPIO_COUNT) {
+        hostGpioLevel[index] = pinConfig & GPIO_CFG_OUT_HIGH;
+    }
+    return GPIO_STATUS_SUCCESS;
+}
+
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback)
+{
+    if (index < HOST_GPIO_COUNT) {
+        gpioCallbacks[index] = callback;
+    }
+}
+
+void GPIO_enableInt(uint_least8_t index)
+{
+}
+
+void GPIO_disableInt(uint_least8_t index)
+{
+}
+
+uint_fast8_t GPIO_read(uint_least8_t index)
+{
+    return (index < HOST_GPIO_COUNT) ? hostGpioLevel[index] : 0;
+}
+
+void GPIO_write(uint_least8_t index, unsigned int value)
+{
+    ++hostGpioWrites;
+    if (index < HOST_GPIO_COUNT) {
+        hostGpioLevel[index] = value;
+    }
+}
+
+void GPIO_toggle(uint_least8_t index)
+{
+    if (index < HOST_GPIO_COUNT) {
+        GPIO_write(index, !hostGpioLevel[index]);
+    }
+}
+
+void hostGpioFire(uint_least8_t index)
+{
+    if (index < HOST_GPIO_COUNT && gpioCallbacks[index] != NULL) {
+        gpioCallbacks[index](index);
+    }
+}
+
+/*
+ *  ======== UART ========
+ */
+bool hostUartQuiet = false;
+unsigned long hostUartBytes = 0;
+static int uartObject;
+static UART_Callback uartReadCallback = NULL;
+static uint8_t *uartReadBuffer = NULL;
+
+void UART_init(void)
+{
+}
+
+void UART_Params_init(UART_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->baudRate = 115200;
+}
+
+UART_Handle UART_open(uint_least8_t index, UART_Params *params)
+{
+    uartReadCallback = (params->readMode == UART_MODE_CALLBACK) ? params->readCallback : NULL;
+    return (UART_Handle)&uartObject;
+}
+
+void UART_close(UART_Handle handle)
+{
+}
+
+unsigned long hostUartByteUs = 0;
+unsigned long hostUartDropPermille = 0;
+unsigned long hostUartStallPermille = 0;
+unsigned long hostUartStallUs = 0;
+unsigned long hostUartDrops = 0;
+unsigned long hostUartStalls = 0;
+
+int_fast32_t UART_write(UART_Handle handle, const void *buffer, size_t size)
+{
+    if (faultHit(&uartFaultRng, hostUartStallPermille)) {
+        ++hostUartStalls;
+        hostWait(hostUartStallUs);
+    }
+    hostWait(size * hostUartByteUs);
+    hostUartBytes += size;
+    if (!hostUartQuiet) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return (int_fast32_t)size;
+}
+
+int_fast32_t UART_writePolling(UART_Handle handle, const void *buffer, size_t size)
+{
+    return UART_write(handle, buffer, size);
+}
+
+int_fast32_t UART_read(UART_Handle handle, void *buffer, size_t size)
+{
+    if (uartReadCallback != NULL && size == 1) {
+        uartReadBuffer = buffer;
+    }
+    return 0;
+}
+
+void hostUartReceive(const char *bytes, size_t len)
+{
+    uint8_t *buffer;
+
+    while (len-- > 0 && uartReadBuffer != NULL) {
+        if (faultHit(&uartFaultRng, hostUartDropPermille)) {
+            ++hostUartDrops;
+            ++bytes;
+            continue;
+        }
+        buffer = uartReadBuffer;
+        uartReadBuffer = NULL;
+        *buffer = (uint8_t)*bytes++;
+        uartReadCallback((UART_Handle)&uartObject, buffer, 1);
+    }
+}
+
+/*
+ *  ======== UART2 ========
+ */
+static const char *uart2Input = NULL;
+static size_t uart2Left = 0;
+static int uart2Object;
+
+void hostUart2Feed(const char *bytes, size_t len)
+{
+    uart2Input = bytes;
+    uart2Left = len;
+}
+
+void UART2_Params_init(UART2_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->baudRate = 115200;
+}
+
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params)
+{
+    return (UART2_Handle)&uart2Object;
+}
+
+void UART2_close(UART2_Handle handle)
+{
+}
+
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead)
+{
+    size_t n = (size < uart2Left) ? size : uart2Left;
+
+    if (n == 0) {
+        *bytesRead = 0;
+        return UART2_STATUS_EAGAIN;
+    }
+    memcpy(buffer, uart2Input, n);
+    uart2Input += n;
+    uart2Left -= n;
+    *bytesRead = n;
+    return UART2_STATUS_SUCCESS;
+}
+
+// Nothing more arrives while the host waits, so an empty queue times out at once
+int_fast16_t UART2_readTimeout(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead, uint32_t timeout)
+{
+    int_fast16_t status = UART2_read(handle, buffer, size, bytesRead);
+
+    return (status == UART2_STATUS_EAGAIN) ? UART2_STATUS_ETIMEOUT : status;
+}
+
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size, size_t *bytesWritten)
+{
+    UART_write(NULL, buffer, size);
+    if (bytesWritten != NULL) {
+        *bytesWritten = size;
+    }
+    return UART2_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== I2C ========
+ */
+#define HOST_I2C_QUEUE_SIZE 256
+
+uint8_t hostI2CPresent[4] = { 0x48 };
+uint16_t hostI2CDefaultRaw = 22 << 7;       // 22 C in TMP sensor units
+unsigned long hostI2CTransferUs = 0;
+unsigned long hostI2CTransfers = 0;
+unsigned long hostI2CBusClears = 0;
+unsigned long hostI2CNackPermille = 0;
+unsigned long hostI2CStuckPermille = 0;
+unsigned long hostI2CTimeoutUs = 0;
+bool hostI2CStuck = false;
+unsigned long hostI2CFaults = 0;
+uint16_t (*hostI2CSensor)(uint_least8_t slaveAddress) = NULL;
+
+static struct {
+    bool ok;
+    int16_t value;
+} i2cQueue[HOST_I2C_QUEUE_SIZE];
+static size_t i2cHead = 0;
+static size_t i2cTail = 0;
+static int i2cObject;
+
+void hostI2CPush(bool ok, int16_t value)
+{
+    if (i2cTail - i2cHead < HOST_I2C_QUEUE_SIZE) {
+        i2cQueue[i2cTail % HOST_I2C_QUEUE_SIZE].ok = ok;
+        i2cQueue[i2cTail % HOST_I2C_QUEUE_SIZE].value = value;
+        ++i2cTail;
+    }
+}
+
+size_t hostI2CQueued(void)
+{
+    return i2cTail - i2cHead;
+}
+
+void I2C_init(void)
+{
+}
+
+void I2C_Params_init(I2C_Params *params)
+{
+    params->bitRate = I2C_100kHz;
+}
+
+I2C_Handle I2C_open(uint_least8_t index, I2C_Params *params)
+{
+    return (I2C_Handle)&i2cObject;
+}
+
+void I2C_close(I2C_Handle handle)
+{
+}
+
+bool I2C_transfer(I2C_Handle handle, I2C_Transaction *transaction)
+{
+    uint8_t *rx = (uint8_t *)transaction->readBuf;
+    uint16_t raw = hostI2CDefaultRaw;
+    size_t i;
+
+    ++hostI2CTransfers;
+    if (!hostI2CStuck && faultHit(&i2cFaultRng, hostI2CStuckPermille)) {
+        ++hostI2CFaults;
+        hostI2CStuck = true;
+    }
+    if (hostI2CStuck) {
+        hostWait(hostI2CTimeoutUs);
+        transaction->status = I2C_STATUS_TIMEOUT;
+        return false;
+    }
+    hostWait(hostI2CTransferUs);
+
+    // Address probe
+    if (transaction->readCount == 0) {
+        for (i = 0; i < sizeof(hostI2CPresent); ++i) {
+            if (hostI2CPresent[i] != 0 && hostI2CPresent[i] == transaction->slaveAddress) {
+                transaction->status = I2C_STATUS_SUCCESS;
+                return true;
+            }
+        }
+        transaction->status = I2C_STATUS_ADDR_NACK;
+        return false;
+    }
+
+    if (faultHit(&i2cFaultRng, hostI2CNackPermille)) {
+        ++hostI2CFaults;
+        transaction->status = I2C_STATUS_ADDR_NACK;
+        return false;
+    }
+
+    if (i2cHead != i2cTail) {
+        size_t slot = i2cHead++ % HOST_I2C_QUEUE_SIZE;
+        if (!i2cQueue[slot].ok) {
+            transaction->status = i2cQueue[slot].value;
+            return false;
+        }
+        raw = (uint16_t)i2cQueue[slot].value;
+    } else if (hostI2CSensor != NULL) {
+        raw = hostI2CSensor(transaction->slaveAddress);
+    }
+
+    rx[0] = raw >> 8;
+    rx[1] = raw & 0xFF;
+    transaction->status = I2C_STATUS_SUCCESS;
+    return true;
+}
+
+// Stand-in for the driverlib bus clear in the thermostat project
+bool i2cBusClear(void)
+{
+    ++hostI2CBusClears;
+    hostI2CStuck = false;
+    return true;
+}
+
+/*
+ *  ======== Timer ========
+ */
+static int timerObject;
+static Timer_CallBackFxn timerCallback = NULL;
+uint32_t hostTimerPeriod = 0;
+bool hostTimerRealTime = false;
+unsigned long hostTimerJitterUs = 0;
+unsigned long hostTimerMissPermille = 0;
+unsigned long hostTimerMisses = 0;
+
+// Calls the timer callback every period from a thread of its own, as the interrupt would.
+// A late tick doesn't move the ones after it.
+static void *timerThread(void *arg0)
+{
+    struct timespec next;
+    struct timespec late;
+    unsigned long lateUs;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (1) {
+        next.tv_nsec += (long)hostTimerPeriod * 1000;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        if (faultHit(&timerFaultRng, hostTimerMissPermille)) {
+            ++hostTimerMisses;
+            continue;
+        }
+        if (hostTimerJitterUs != 0) {
+            lateUs = faultNext(&timerFaultRng) % (hostTimerJitterUs + 1);
+            late.tv_sec = lateUs / 1000000;
+            late.tv_nsec = (long)(lateUs % 1000000) * 1000;
+            nanosleep(&late, NULL);
+        }
+        timerCallback((Timer_Handle)&timerObject, 0);
+    }
+    return NULL;
+}
+
+void Timer_init(void)
+{
+}
+
+void Timer_Params_init(Timer_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+Timer_Handle Timer_open(uint_least8_t index, Timer_Params *params)
+{
+    hostTimerPeriod = params->period;
+    timerCallback = params->timerCallback;
+    return (Timer_Handle)&timerObject;
+}
+
+int32_t Timer_start(Timer_Handle handle)
+{
+    pthread_t thread;
+
+    if (hostTimerRealTime && timerCallback != NULL) {
+        if (pthread_create(&thread, NULL, timerThread, NULL) != 0) {
+            return Timer_STATUS_ERROR;
+        }
+        pthread_detach(thread);
+    }
+    return Timer_STATUS_SUCCESS;
+}
+
+void Timer_stop(Timer_Handle handle)
+{
+}
+
+int32_t Timer_setPeriod(Timer_Handle handle, Timer_PeriodUnits periodUnits, uint32_t period)
+{
+    hostTimerPeriod = period;
+    return Timer_STATUS_SUCCESS;
+}
+
+void Timer_close(Timer_Handle handle)
+{
+}
+
+/*
+ *  ======== SimpleLink file system ========
+ */
+#define HOST_FS_FILES       4
+#define HOST_FS_NAME_MAX    64
+#define HOST_FS_FILE_MAX    1024
+
+unsigned long hostFsWrites = 0;
+unsigned long hostFsWriteUs = 0;
+
+static struct {
+    char name[HOST_FS_NAME_MAX];
+    uint8_t data[HOST_FS_FILE_MAX];
+    _u32 size;
+    bool used;
+} fsFiles[HOST_FS_FILES];
+
+// Handles are the file index, plus HOST_FS_FILES for one opened for writing
+static uint8_t fsShadow[HOST_FS_FILE_MAX];
+static _u32 fsShadowSize;
+
+void hostFsErase(void)
+{
+    memset(fsFiles, 0, sizeof(fsFiles));
+}
+
+_i16 sl_Start(const void *pIfHdl, _i8 *pDevName, const P_INIT_CALLBACK pInitCallBack)
+{
+    return 0;
+}
+
+_i32 sl_FsOpen(const _u8 *pFileName, const _u32 AccessModeAndMaxSize, _u32 *pToken)
+{
+    int i;
+    int empty = -1;
+
+    for (i = 0; i < HOST_FS_FILES; ++i) {
+        if (fsFiles[i].used && strcmp(fsFiles[i].name, (const char *)pFileName) == 0) {
+            break;
+        }
+        if (!fsFiles[i].used && empty < 0) {
+            empty = i;
+        }
+    }
+    if ((AccessModeAndMaxSize & SL_FS_CREATE) == 0) {
+        return (i < HOST_FS_FILES) ? i : SL_ERROR_FS_FILE_NOT_EXISTS;
+    }
+    if (i == HOST_FS_FILES) {
+        if (empty < 0 || strlen((const char *)pFileName) >= HOST_FS_NAME_MAX) {
+            return -1;
+        }
+        i = empty;
+        strcpy(fsFiles[i].name, (const char *)pFileName);
+        fsFiles[i].size = 0;
+        fsFiles[i].used = true;
+    }
+    fsShadowSize = 0;
+    return HOST_FS_FILES + i;
+}
+
+_i32 sl_FsRead(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len)
+{
+    if (FileHdl < 0 || FileHdl >= HOST_FS_FILES || Offset > fsFiles[FileHdl].size) {
+        return -1;
+    }
+    if (Len > fsFiles[FileHdl].size - Offset) {
+        Len = fsFiles[FileHdl].size - Offset;
+    }
+    memcpy(pData, fsFiles[FileHdl].data + Offset, Len);
+    return (_i32)Len;
+}
+
+_i32 sl_FsWrite(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len)
+{
+    if (FileHdl < HOST_FS_FILES || FileHdl >= 2 * HOST_FS_FILES || Offset + Len > HOST_FS_FILE_MAX) {
+        return -1;
+    }
+    memcpy(fsShadow + Offset, pData, Len);
+    if (Offset + Len > fsShadowSize) {
+        fsShadowSize = Offset + Len;
+    }
+    return (_i32)Len;
+}
+
+_i16 sl_FsClose(const _i32 FileHdl, const _u8 *pCeritificateFileName, const _u8 *pSignature, const _u32 SignatureLen)
+{
+    if (FileHdl >= HOST_FS_FILES && FileHdl < 2 * HOST_FS_FILES) {
+        memcpy(fsFiles[FileHdl - HOST_FS_FILES].data, fsShadow, fsShadowSize);
+        fsFiles[FileHdl - HOST_FS_FILES].size = fsShadowSize;
+        ++hostFsWrites;
+        hostWait(hostFsWriteUs);
+    }
+    return 0;
+}
+
+/*
+ *  ======== Watchdog ========
+ */
+unsigned long hostWatchdogClears = 0;
+uint32_t hostWatchdogReload = 0;
+static int watchdogObject;
+static Watchdog_Callback watchdogCallback = NULL;
+
+void Watchdog_init(void)
+{
+}
+
+void Watchdog_Params_init(Watchdog_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->resetMode = Watchdog_RESET_ON;
+}
+
+Watchdog_Handle Watchdog_open(uint_least8_t index, Watchdog_Params *params)
+{
+    watchdogCallback = params->callbackFxn;
+    return (Watchdog_Handle)&watchdogObject;
+}
+
+void Watchdog_clear(Watchdog_Handle handle)
+{
+    ++hostWatchdogClears;
+}
+
+// Ticks of the 80 MHz clock the CC32XX watchdog counts
+uint32_t Watchdog_convertMsToTicks(Watchdog_Handle handle, uint32_t milliseconds)
+{
+    return (milliseconds <= UINT32_MAX / 80000) ? milliseconds * 80000 : 0;
+}
+
+int_fast16_t Watchdog_setReload(Watchdog_Handle handle, uint32_t ticks)
+{
+    hostWatchdogReload = ticks;
+    return Watchdog_STATUS_SUCCESS;
+}
+
+void Watchdog_close(Watchdog_Handle handle)
+{
+    watchdogCallback = NULL;
+}
+
+void hostWatchdogExpire(void)
+{
+    if (watchdogCallback != NULL) {
+        watchdogCallback((uintptr_t)&watchdogObject);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ *  ======== host_drivers.h ========
+ *  Controls for the host stand-ins of the TI drivers. The applications only see
+ *  the normal driver API; the host tools use these hooks to feed sensor data,
+ *  press buttons and watch the outputs.
+ */
+#ifndef HOST_DRIVERS_H_
+#define HOST_DRIVERS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HOST_GPIO_COUNT 32
+
+// GPIO
+extern unsigned int hostGpioLevel[HOST_GPIO_COUNT];
+extern unsigned long hostGpioWrites;
+void hostGpioFire(uint_least8_t index);     // Runs the pin's interrupt callback
+
+// UART. Output goes to stdout unless hostUartQuiet is set. Writes take
+// hostUartByteUs per byte, 87 for a real 115200 baud line.
+extern bool hostUartQuiet;
+extern unsigned long hostUartBytes;
+extern unsigned long hostUartByteUs;
+// Delivers bytes to a callback mode UART_read(), one per pending read
+void hostUartReceive(const char *bytes, size_t len);
+
+// UART2 reads return the fed bytes, then UART2_STATUS_EAGAIN once they run out
+void hostUart2Feed(const char *bytes, size_t len);
+
+// I2C. A probe (readCount == 0) succeeds for any address in hostI2CPresent.
+// Reads pop queued results in order; once the queue is empty they return
+// what hostI2CSensor gives for the address, or hostI2CDefaultRaw without it.
+extern uint8_t hostI2CPresent[4];
+extern uint16_t hostI2CDefaultRaw;
+extern unsigned long hostI2CTransfers;
+extern unsigned long hostI2CBusClears;
+extern unsigned long hostI2CTransferUs;     // Time each transfer takes
+extern uint16_t (*hostI2CSensor)(uint_least8_t slaveAddress);
+void hostI2CPush(bool ok, int16_t value);   // value is the raw register, or the status on failure
+size_t hostI2CQueued(void);
+
+// Watchdog. hostWatchdogExpire() runs the callback as the first timeout would.
+extern unsigned long hostWatchdogClears;
+extern uint32_t hostWatchdogReload;         // Last Watchdog_setReload(), in 80 MHz ticks
+void hostWatchdogExpire(void);
+
+// Timer. The period last given to Timer_open() or Timer_setPeriod(), in microseconds.
+// With hostTimerRealTime set before Timer_start(), a thread calls the callback
+// every period; otherwise the host tools drive time themselves.
+extern uint32_t hostTimerPeriod;
+extern bool hostTimerRealTime;
+
+// SimpleLink file system, kept in memory. A file opened for writing is replaced when
+// it is closed, as with a fail-safe file on the board; each replacement counts in
+// hostFsWrites and takes hostFsWriteUs. hostFsErase() drops every file.
+extern unsigned long hostFsWrites;
+extern unsigned long hostFsWriteUs;
+void hostFsErase(void);
+
+// Faults, all off by default. Rates are per thousand reads, bytes or ticks, drawn
+// from generators restarted by hostFaultSeed(), so a seed gives the same faults
+// every run. Scripted I2C failures go through hostI2CPush() instead.
+//  I2C: a read fails with I2C_STATUS_ADDR_NACK, or a transfer leaves the bus
+//  stuck (hostI2CStuck). Every transfer on a stuck bus times out after
+//  hostI2CTimeoutUs until i2cBusClear() frees it.
+//  UART: a received byte is lost, or a write stalls for hostUartStallUs first.
+//  Timer: a tick comes up to hostTimerJitterUs late, or is lost. Only the real
+//  time timer thread (hostTimerRealTime) applies these.
+extern unsigned long hostI2CNackPermille;
+extern unsigned long hostI2CStuckPermille;
+extern unsigned long hostI2CTimeoutUs;
+extern bool hostI2CStuck;
+extern unsigned long hostI2CFaults;
+extern unsigned long hostUartDropPermille;
+extern unsigned long hostUartStallPermille;
+extern unsigned long hostUartStallUs;
+extern unsigned long hostUartDrops;
+extern unsigned long hostUartStalls;
+extern unsigned long hostTimerJitterUs;
+extern unsigned long hostTimerMissPermille;
+extern unsigned long hostTimerMisses;
+void hostFaultSeed(uint32_t seed);
+
+// Clock. With hostClockSimulated set, cyclesNow() returns hostClockNs and the
+// driver delays above advance it instead of sleeping.
+extern bool hostClockSimulated;
+extern volatile uint32_t hostClockNs;
+
+#endif /* HOST_DRIVERS_H_ */
@@ -0,0 +1,284 @@
+/*
+ *  ======== plant.c ========
+ *  Runs the thermostat in closed loop against a model of the rooms it heats,
+ *  in virtual time, and reports how well each control law (control.h) holds
+ *  the temperature.
+ *
+ *  Each zone heats a room made of two lumps: the heater body, which the heater
+ *  warms, and the room air, which the heater body warms and which loses heat to
+ *  the outside. The heater body is what keeps the air warming for a while after
+ *  the heater switches off. The sensor reads the air with some noise and the
+ *  thermostat gets the reading through the I2C stand-in (hostI2CSensor); the
+ *  heater power is taken from the heater GPIO, or from the zone table for a
+ *  zone with no pin on the LaunchPad.
+ *
+ *  Every scenario runs once per control law and prints one JSON line with the
+ *  heater energy, settling time, overshoot and heater switch-ons over the
+ *  measured part of the run, and the host time per scheduler pass. The same
+ *  seed gives the same figures, apart from the pass times, on any machine.
+ *
+ *  Usage: plant [-s seed] [scenario...]     (a name fragment runs only the matching scenarios)
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "ti_drivers_config.h"
+
+#include "control.h"
+#include "cycles.h"
+#include "duty.h"
+#include "filter.h"
+#include "gpiointerrupt.h"
+#include "zones.h"
+
+#include "host_drivers.h"
+
+#if defined(THERMOSTAT_FREERTOS)
+#error "plant simulates the NoRTOS main loop"
+#endif
+
+#define HEATER_CAPACITY     30000.0     // J/K, element and casing
+#define HEATER_TO_AIR       150.0       // W/K
+#define AIR_CAPACITY        300000.0    // J/K, air and furnishings of a small room
+#define AIR_TO_OUTSIDE      40.0        // W/K through the walls and windows
+#define DOOR_TO_OUTSIDE     400.0       // W/K more while the door is open
+#define OUTSIDE_TEMP        5.0         // C
+#define SENSOR_NOISE        0.05        // C, peak
+#define SETTLE_BAND         0.5         // C either side of the setpoint
+
+typedef struct scenario {
+    const char *name;
+    double startTemp;           // Air and heater body at the start, C
+    int16_t setBefore;          // Setpoint during the warm-up
+    int16_t setAfter;           // Setpoint from the event on
+    unsigned long warmupS;      // Unmeasured run before the event
+    unsigned long doorS;        // Door open for this long from the event
+    unsigned long runS;         // Measured run from the event
+} scenario;
+
+static const scenario scenarios[] = {
+    { "cold_start", 12.0, 22, 22, 0,    0,   3 * 3600 },
+    { "door_open",  22.0, 22, 22, 3600, 300, 2 * 3600 },
+    { "step_up",    22.0, 22, 24, 3600, 0,   2 * 3600 },
+    { "step_down",  22.0, 22, 20, 3600, 0,   2 * 3600 },
+};
+
+static const char *const modeNames[CTRL_NUM_MODES] = { "hysteresis", "deadband", "pid" };
+
+// Same order as sensors[] in gpiointerrupt.c; zone z reads sensor z
+static const uint8_t sensorAddress[3] = { 0x48, 0x49, 0x41 };
+
+static struct {
+    double air[NUM_ZONES];
+    double heater[NUM_ZONES];
+    double loss;                // W/K from the air to the outside
+} room;
+
+static uint32_t rngSeed;
+static uint32_t rngState;
+
+// xorshift32, so runs do not depend on the C library's rand()
+static uint32_t rngNext(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// The air temperature with noise, in TMP sensor units
+static uint16_t sensorRead(uint_least8_t slaveAddress)
+{
+    double noise = ((rngNext() >> 8) + (rngNext() >> 8)) / (double)(1 << 24) - 1.0;
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        if (sensorAddress[z] == slaveAddress) {
+            return (uint16_t)(int16_t)lround((room.air[z] + noise * SENSOR_NOISE) * (1 << TEMP_FRACTION_BITS));
+        }
+    }
+    return 0;
+}
+
+static bool heaterOn(uint8_t z)
+{
+    if (zones.heaterPin[z] != ZONE_NO_PIN) {
+        return hostGpioLevel[zones.heaterPin[z]] != 0;
+    }
+    return zones.heaterState[z] == HTR_On;
+}
+
+// Advances every room by ms with the heaters as they are now
+static void roomStep(unsigned long ms)
+{
+    double dt = ms / 1000.0;
+    double toAir;
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        toAir = HEATER_TO_AIR * (room.heater[z] - room.air[z]);
+        room.heater[z] += ((heaterOn(z) ? DUTY_HEATER_WATTS : 0) - toAir) / HEATER_CAPACITY * dt;
+        room.air[z] += (toAir - room.loss * (room.air[z] - OUTSIDE_TEMP)) / AIR_CAPACITY * dt;
+    }
+}
+
+static struct {
+    double energyJ;
+    double overshoot;           // C past the setpoint once it has been reached
+    unsigned long outOfBandMs;  // Last time a room was outside SETTLE_BAND, from the event
+    unsigned long switches;     // Heater switch-ons
+    uint64_t passNs;
+    uint32_t passMaxNs;
+    unsigned long passes;
+    bool reached[NUM_ZONES];
+} result;
+
+// One scheduler pass, then the rooms move on by one tick. With measure set the pass is
+// counted in result, elapsedMs after the event.
+static void tick(bool measure, unsigned long elapsedMs, int direction)
+{
+    bool before[NUM_ZONES];
+    uint32_t start;
+    uint32_t ns;
+    double past;
+    uint8_t z;
+
+    for (z = 0; z < NUM_ZONES; ++z) {
+        before[z] = heaterOn(z);
+    }
+    start = cyclesNow();
+    runTasks();
+    ns = cyclesNow() - start;
+    roomStep(timerPeriod);
+
+    if (!measure) {
+        return;
+    }
+    result.passNs += ns;
+    if (ns > result.passMaxNs) {
+        result.passMaxNs = ns;
+    }
+    ++result.passes;
+    for (z = 0; z < NUM_ZONES; ++z) {
+        if (heaterOn(z)) {
+            result.energyJ += DUTY_HEATER_WATTS * (timerPeriod / 1000.0);
+            if (!before[z]) {
+                ++result.switches;
+            }
+        }
+        past = direction * (room.air[z] - zones.setTempCelsius[z]);
+        if (past >= 0) {
+            result.reached[z] = true;
+        }
+        if (result.reached[z] && past > result.overshoot) {
+            result.overshoot = past;
+        }
+        if (fabs(room.air[z] - zones.setTempCelsius[z]) > SETTLE_BAND) {
+            result.outOfBandMs = elapsedMs + timerPeriod;
+        }
+    }
+}
+
+static void runScenario(const scenario *s, uint8_t mode)
+{
+    unsigned long ms;
+    int16_t sample;
+    int direction;
+    uint8_t z;
+
+    // Start up as mainThread() does, with the heaters off and a first reading in the filter.
+    // Every run gets the same sensor noise.
+    rngState = rngSeed;
+    GPIO_init();
+    for (z = 0; z < NUM_ZONES; ++z) {
+        room.air[z] = s->startTemp;
+        room.heater[z] = s->startTemp;
+    }
+    room.loss = AIR_TO_OUTSIDE;
+    zonesInit(s->setBefore, DEFAULT_HYSTERESIS);
+    for (z = 0; z < NUM_ZONES; ++z) {
+        sample = (int16_t)sensorRead(sensorAddress[z]);
+        filterReset(z, sample);
+        zones.filteredTemp[z] = sample;
+        zones.currentTempCelsius[z] = tempToCelsius(sample);
+        zones.stale[z] = 0;
+    }
+    initTasks();
+    for (z = 0; z < NUM_ZONES; ++z) {
+        controlSetMode(z, mode);
+    }
+
+    for (ms = 0; ms < s->warmupS * 1000; ms += timerPeriod) {
+        tick(false, 0, 0);
+    }
+
+    memset(&result, 0, sizeof(result));
+    direction = (s->setAfter < room.air[0]) ? -1 : 1;
+    for (z = 0; z < NUM_ZONES; ++z) {
+        zones.setTempCelsius[z] = s->setAfter;
+    }
+    for (ms = 0; ms < s->runS * 1000; ms += timerPeriod) {
+        room.loss = AIR_TO_OUTSIDE + ((ms < s->doorS * 1000) ? DOOR_TO_OUTSIDE : 0);
+        tick(true, ms, direction);
+    }
+
+    // A run that ends outside the band never settled
+    printf("{\"scenario\":\"%s\",\"control\":\"%s\",\"energy_wh\":%.1f,\"settle_s\":%ld,"
+           "\"overshoot_c\":%.2f,\"switches\":%lu,\"pass_ns\":%.1f,\"pass_max_ns\":%lu}\n",
+           s->name, modeNames[mode], result.energyJ / 3600.0,
+           (result.outOfBandMs >= ms) ? -1L : (long)(result.outOfBandMs / 1000),
+           result.overshoot, result.switches,
+           result.passes ? (double)result.passNs / result.passes : 0.0,
+           (unsigned long)result.passMaxNs);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t c;
+    uint8_t mode;
+    int opt;
+    int i;
+    bool wanted;
+
+    rngSeed = 1;
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        switch (opt) {
+            case 's':
+                rngSeed = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "usage: plant [-s seed] [scenario...]\n");
+                return 1;
+        }
+    }
+    if (rngSeed == 0) {
+        rngSeed = 1;
+    }
+
+    hostUartQuiet = true;
+    hostI2CSensor = sensorRead;
+    cyclesInit();
+    initUART();
+    initI2C();
+
+    for (c = 0; c < sizeof(scenarios) / sizeof(scenarios[0]); ++c) {
+        wanted = (optind == argc);
+        for (i = optind; i < argc; ++i) {
+            if (strstr(scenarios[c].name, argv[i]) != NULL) {
+                wanted = true;
+            }
+        }
+        if (!wanted) {
+            continue;
+        }
+        for (mode = 0; mode < CTRL_NUM_MODES; ++mode) {
+            runScenario(&scenarios[c], mode);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ *  ======== presslat.c ========
+ *  Measures how long a button press takes to change the setpoint, from the
+ *  GPIO interrupt to the button task applying it (latency.h), on a simulated
+ *  clock.
+ *
+ *  The NoRTOS main loop is run tick by tick against the stand-in drivers while
+ *  presses land at random times between the ticks. I2C transfers and UART
+ *  writes advance the clock by the time they take on the board, so a pass that
+ *  runs long delays the tasks behind it the way it would there. The same seed
+ *  gives the same numbers on any machine.
+ *
+ *  One JSON object is printed per button task period. Build once per
+ *  SCHED_POLICY to compare the scheduler policies. Each object also gives the
+ *  most slices any task ran in one pass, from the event trace (trace.h). A
+ *  coroutine task that yields (pt.h) carries on at the next tick, so this
+ *  should be 1 under every policy; the exit status is 2 if it isn't.
+ *
+ *  Usage: presslat [-n presses] [-s seed] [-u us_per_uart_byte] [-i us_per_i2c_transfer]
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "ti_drivers_config.h"
+
+#include "gpiointerrupt.h"
+#include "latency.h"
+#include "trace.h"
+#include "zones.h"
+
+#include "host_drivers.h"
+
+#if defined(THERMOSTAT_FREERTOS)
+#error "presslat simulates the NoRTOS main loop"
+#endif
+
+#if !TRACE_ENABLE
+#error "presslat counts task slices from the event trace"
+#endif
+
+#if SCHED_POLICY == 2
+#define SCHED_NAME "edf"
+#elif SCHED_POLICY == 1
+#define SCHED_NAME "priority"
+#else
+#define SCHED_NAME "array"
+#endif
+
+#define MAX_PRESS_GAP_MS 2000
+
+static const unsigned long buttonPeriods[] = { 50, 100, 200 };
+
+static uint32_t rngState;
+
+// xorshift32, so runs do not depend on the C library's rand()
+static uint32_t rngNext(void)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static uint64_t simNs;
+static unsigned int maxSlices;
+
+// Moves the simulated clock to t, or picks up what the drivers added to it
+static void clockSync(uint64_t t)
+{
+    simNs += (uint32_t)(hostClockNs - (uint32_t)simNs);
+    if (t > simNs) {
+        simNs = t;
+    }
+    hostClockNs = (uint32_t)simNs;
+}
+
+// Counts the task begin records a pass left in the trace, from record number from on.
+// A pass logs far fewer records than the ring holds.
+static unsigned int passSlices(uint32_t from)
+{
+    unsigned int runs[NUM_TASKS] = { 0 };
+    unsigned int most = 0;
+    const traceRecord *r;
+    uint32_t n;
+
+    for (n = from; n != traceBuffer.count; ++n) {
+        r = &traceBuffer.ring[n & (TRACE_RING_SIZE - 1)];
+        if (r->type == TRACE_TaskBegin && r->id < NUM_TASKS && ++runs[r->id] > most) {
+            most = runs[r->id];
+        }
+    }
+    return most;
+}
+
+static unsigned int runConfig(unsigned long buttonPeriod, unsigned long presses)
+{
+    uint32_t passStart;
+    unsigned int slices;
+    uint64_t nextTick;
+    uint64_t nextPress;
+    unsigned long pressed = 0;
+    uint64_t tickNs;
+
+    initTasks();
+    taskSetPeriod(TASK_CheckUpBtn, buttonPeriod);
+    taskSetPeriod(TASK_CheckDownBtn, buttonPeriod);
+    latencyReset(&pressLatency);
+    maxSlices = 0;
+
+    nextTick = simNs;
+    nextPress = simNs + (uint64_t)(rngNext() % (MAX_PRESS_GAP_MS * 1000)) * 1000;
+
+    while (pressed < presses || upBtnPressed || downBtnPressed) {
+        if (pressed < presses && nextPress < nextTick) {
+            // The interrupt preempts whatever was running, so it sees the press time
+            clockSync(0);
+            hostClockNs = (uint32_t)nextPress;
+            hostGpioFire((pressed & 1) ? CONFIG_GPIO_BUTTON_1 : CONFIG_GPIO_BUTTON_0);
+            hostClockNs = (uint32_t)simNs;
+            ++pressed;
+            nextPress += (uint64_t)(rngNext() % (MAX_PRESS_GAP_MS * 1000)) * 1000;
+            continue;
+        }
+
+        // A pass that overran its tick starts late; ticks it covered completely are lost
+        clockSync(nextTick);
+        timerFlag = 0;
+        passStart = traceBuffer.count;
+        runTasks();
+        slices = passSlices(passStart);
+        if (slices > maxSlices) {
+            maxSlices = slices;
+        }
+        clockSync(0);
+        tickNs = (uint64_t)timerPeriod * 1000000;
+        nextTick += tickNs;
+        while (nextTick + tickNs <= simNs) {
+            nextTick += tickNs;
+        }
+    }
+
+    printf("{\"sched\":\"%s\",\"button_period_ms\":%lu,\"tick_ms\":%lu,\"presses\":%lu,"
+           "\"p50_ms\":%.1f,\"p99_ms\":%.1f,\"max_ms\":%.1f,\"max_slices_per_pass\":%u}\n",
+           SCHED_NAME, buttonPeriod, timerPeriod, (unsigned long)pressLatency.count,
+           latencyPercentile(&pressLatency, 50) / 1000.0,
+           latencyPercentile(&pressLatency, 99) / 1000.0,
+           pressLatency.maxUs / 1000.0, maxSlices);
+    return maxSlices;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long presses = 1000;
+    bool backToBack = false;
+    size_t c;
+    int opt;
+
+    rngState = 1;
+    hostUartByteUs = 87;
+    hostI2CTransferUs = 300;
+    while ((opt = getopt(argc, argv, "n:s:u:i:")) != -1) {
+        switch (opt) {
+            case 'n':
+                presses = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                rngState = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                hostUartByteUs = strtoul(optarg, NULL, 10);
+                break;
+            case 'i':
+                hostI2CTransferUs = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "usage: presslat [-n presses] [-s seed] [-u us_per_uart_byte] [-i us_per_i2c_transfer]\n");
+                return 1;
+        }
+    }
+    if (rngState == 0) {
+        rngState = 1;
+    }
+
+    hostUartQuiet = true;
+    hostClockSimulated = true;
+    GPIO_init();
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, gpioButtonFxn0);
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_1, gpioButtonFxn1);
+    traceInit();
+    initUART();
+    initI2C();
+    zonesInit(DEFAULT_SET_TEMP, DEFAULT_HYSTERESIS);
+
+    for (c = 0; c < sizeof(buttonPeriods) / sizeof(buttonPeriods[0]); ++c) {
+        if (runConfig(buttonPeriods[c], presses) > 1) {
+            backToBack = true;
+        }
+    }
+    return backToBack ? 2 : 0;
+}
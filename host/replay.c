@@ -0,0 +1,152 @@
+/*
+ *  ======== replay.c ========
+ *  Replays a flight recorder dump from the thermostat (gpiointerrupt) through the
+ *  real tick functions on the host, as fast as it will go.
+ *
+ *  The dump is the text the board prints when both buttons are pressed together;
+ *  any other console output in the capture is ignored. Sensor samples are fed back
+ *  through the I2C stand-in, button events through the GPIO callbacks, and each
+ *  recorded tick runs the scheduler once. The same trace always produces the same
+ *  report lines, so a captured field run can be kept as a regression case.
+ *
+ *  Usage: replay [-q] [trace.txt]     (reads stdin without a file; -q hides the reports)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "ti_drivers_config.h"
+
+#include "gpiointerrupt.h"
+#include "recorder.h"
+#include "zones.h"
+
+#include "host_drivers.h"
+
+static recEvent *events;
+static size_t numEvents;
+
+static void loadTrace(FILE *in)
+{
+    char line[256];
+    size_t capacity = 1024;
+
+    events = malloc(capacity * sizeof(*events));
+    numEvents = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        const char *p = strstr(line, "@R,");
+        unsigned long time;
+        unsigned int type, arg;
+        int value;
+
+        // begin/end markers and unrelated console output don't parse
+        if (p == NULL || sscanf(p, "@R,%lu,%u,%u,%d", &time, &type, &arg, &value) != 4) {
+            continue;
+        }
+        if (numEvents == capacity) {
+            capacity *= 2;
+            events = realloc(events, capacity * sizeof(*events));
+        }
+        events[numEvents].time = (uint32_t)time;
+        events[numEvents].type = (uint8_t)type;
+        events[numEvents].arg = (uint8_t)arg;
+        events[numEvents].value = (int16_t)value;
+        ++numEvents;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    size_t i, j, start = 0;
+    unsigned long ticks = 0, divergences = 0;
+    struct timespec t0, t1;
+    double seconds;
+
+    for (i = 1; i < (size_t)argc; ++i) {
+        if (strcmp(argv[i], "-q") == 0) {
+            hostUartQuiet = true;
+        } else if ((in = fopen(argv[i], "r")) == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    loadTrace(in);
+    if (numEvents == 0) {
+        fprintf(stderr, "replay: no @R events in input\n");
+        return 1;
+    }
+
+    GPIO_init();
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, gpioButtonFxn0);
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_1, gpioButtonFxn1);
+    initUART();
+    initI2C();
+    zonesInit(DEFAULT_SET_TEMP, DEFAULT_HYSTERESIS);
+    initTasks();
+
+    // A ring that wrapped starts mid-run; begin at the first setpoint keyframe
+    // so the replay starts from the setpoints the board had at that point
+    for (i = 0; i < numEvents; ++i) {
+        if (events[i].type == REC_Setpoint) {
+            start = i;
+            break;
+        }
+    }
+    for (i = start; i < numEvents && events[i].type == REC_Setpoint; ++i) {
+        if (events[i].arg < NUM_ZONES) {
+            zones.setTempCelsius[events[i].arg] = events[i].value;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (; i < numEvents; ++i) {
+        const recEvent *e = &events[i];
+
+        switch (e->type) {
+            case REC_Tick:
+                // Queue the sensor results read during this tick before running it
+                for (j = i + 1; j < numEvents && events[j].type != REC_Tick; ++j) {
+                    if (events[j].type == REC_Temp) {
+                        hostI2CPush(true, events[j].value);
+                    } else if (events[j].type == REC_TempFail) {
+                        hostI2CPush(false, events[j].value);
+                    }
+                }
+                runTasks();
+                ++ticks;
+                break;
+            case REC_UpBtn:
+                hostGpioFire(CONFIG_GPIO_BUTTON_0);
+                break;
+            case REC_DownBtn:
+                hostGpioFire(CONFIG_GPIO_BUTTON_1);
+                break;
+            case REC_Setpoint:
+                // Keyframes later in the run check that the replay is still in step
+                if (e->arg < NUM_ZONES && zones.setTempCelsius[e->arg] != e->value) {
+                    ++divergences;
+                }
+                break;
+            case REC_Deadline:
+                // The board held its heaters off from here until the watchdog reset it
+                zonesFailSafe();
+                break;
+            default:
+                break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr, "replay: %lu events, %lu ticks (%.1f s of device time) in %.6f s, %lu divergences\n",
+            (unsigned long)(numEvents - start), ticks, ticks * timerPeriod / 1000.0, seconds, divergences);
+
+    free(events);
+    return divergences ? 2 : 0;
+}
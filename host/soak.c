@@ -0,0 +1,170 @@
+/*
+ *  ======== soak.c ========
+ *  Runs the thermostat in real time against the host stand-ins and prints how
+ *  late each task started, to compare the NoRTOS loop with the FreeRTOS build
+ *  (THERMOSTAT_FREERTOS, run on Linux pthreads).
+ *
+ *  The timer stand-in fires from a thread of its own, and I2C transfers and
+ *  UART writes can be given the time they take on the board so that slow
+ *  reporting gets in the way the way it would there. One JSON object is printed
+ *  per task, then one with the I2C, UART and timer fault counts.
+ *
+ *  -f turns on the stand-in faults (host_drivers.h) from a list of name=value
+ *  pairs, e.g. -f i2c_nack=20,i2c_stuck=5,i2c_timeout_us=10000. The names are
+ *  those in faultOptions[] below; -s seeds them. With uart_drop set, a "tasks"
+ *  command is typed on the console once a second so the dropped bytes land in
+ *  the command parser.
+ *
+ *  -T saves the event trace ring (trace.h) to a file at the end of the run,
+ *  laid out as the debugger would save it from the board, for host/trace2json.c.
+ *
+ *  Usage: soak [-t seconds] [-u us_per_uart_byte] [-i us_per_i2c_transfer] [-f faults] [-s seed] [-T file] [-v]
+ *  -v shows the console output.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gpiointerrupt.h"
+#include "trace.h"
+#include "zones.h"
+
+#include "host_drivers.h"
+
+#if defined(THERMOSTAT_FREERTOS)
+#define BUILD_NAME "freertos"
+#else
+#define BUILD_NAME "nortos"
+#endif
+
+extern void *mainThread(void *arg0);
+
+static const struct {
+    const char *name;
+    unsigned long *value;
+} faultOptions[] = {
+    { "i2c_nack",        &hostI2CNackPermille },
+    { "i2c_stuck",       &hostI2CStuckPermille },
+    { "i2c_timeout_us",  &hostI2CTimeoutUs },
+    { "uart_drop",       &hostUartDropPermille },
+    { "uart_stall",      &hostUartStallPermille },
+    { "uart_stall_us",   &hostUartStallUs },
+    { "timer_jitter_us", &hostTimerJitterUs },
+    { "timer_miss",      &hostTimerMissPermille },
+};
+
+#define NUM_FAULT_OPTIONS (sizeof(faultOptions) / sizeof(faultOptions[0]))
+
+// Sets the faults in a list like "i2c_nack=20,uart_stall=5"
+static bool parseFaults(char *spec)
+{
+    char *item;
+    char *value;
+    size_t k;
+
+    for (item = strtok(spec, ","); item != NULL; item = strtok(NULL, ",")) {
+        if ((value = strchr(item, '=')) == NULL) {
+            return false;
+        }
+        *value++ = '\0';
+        for (k = 0; k < NUM_FAULT_OPTIONS; ++k) {
+            if (strcmp(item, faultOptions[k].name) == 0) {
+                break;
+            }
+        }
+        if (k == NUM_FAULT_OPTIONS) {
+            return false;
+        }
+        *faultOptions[k].value = strtoul(value, NULL, 10);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int seconds = 10;
+    unsigned long commands = 0;
+    unsigned int stale = 0;
+    const char *tracePath = NULL;
+    FILE *traceFile;
+    pthread_t thread;
+    unsigned char i;
+    int opt;
+
+    hostUartQuiet = true;
+    while ((opt = getopt(argc, argv, "t:u:i:f:s:T:v")) != -1) {
+        switch (opt) {
+            case 't':
+                seconds = strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                hostUartByteUs = strtoul(optarg, NULL, 10);
+                break;
+            case 'i':
+                hostI2CTransferUs = strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                if (!parseFaults(optarg)) {
+                    fprintf(stderr, "soak: bad fault list\n");
+                    return 1;
+                }
+                break;
+            case 's':
+                hostFaultSeed((uint32_t)strtoul(optarg, NULL, 10));
+                break;
+            case 'T':
+                tracePath = optarg;
+                break;
+            case 'v':
+                hostUartQuiet = false;
+                break;
+            default:
+                fprintf(stderr, "usage: soak [-t seconds] [-u us_per_uart_byte] [-i us_per_i2c_transfer] [-f faults] [-s seed] [-T file] [-v]\n");
+                return 1;
+        }
+    }
+
+    // The NoRTOS mainThread() never returns and the FreeRTOS one returns once its
+    // threads are going, so it gets a thread of its own either way
+    hostTimerRealTime = true;
+    if (pthread_create(&thread, NULL, mainThread, NULL) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+    while (seconds-- > 0) {
+        sleep(1);
+        if (hostUartDropPermille != 0) {
+            hostUartReceive("tasks\r", 6);
+            ++commands;
+        }
+    }
+
+    if (tracePath != NULL) {
+        traceFrozen = true;
+        traceFile = fopen(tracePath, "wb");
+        if (traceFile == NULL || fwrite(&traceBuffer, sizeof(traceBuffer), 1, traceFile) != 1) {
+            perror(tracePath);
+        }
+        if (traceFile != NULL) {
+            fclose(traceFile);
+        }
+    }
+
+    for (i = 0; i < numTasks; ++i) {
+        printf("{\"build\":\"%s\",\"sched\":%d,\"task\":%u,\"runs\":%lu,\"misses\":%lu,\"worst_latency_us\":%lu}\n",
+               BUILD_NAME, SCHED_POLICY, i, taskStats.runs[i], taskStats.misses[i], taskStats.worstLatencyUs[i]);
+    }
+    for (i = 0; i < NUM_ZONES; ++i) {
+        stale += zones.stale[i] > ZONE_STALE_LIMIT;
+    }
+    printf("{\"build\":\"%s\",\"sched\":%d,\"i2c_reads\":%lu,\"i2c_faults\":%lu,\"i2c_failures\":%lu,"
+           "\"i2c_recoveries\":%lu,\"i2c_skipped\":%lu,\"bus_clears\":%lu,\"stale_zones\":%u,"
+           "\"uart_drops\":%lu,\"uart_stalls\":%lu,\"commands\":%lu,\"timer_misses\":%lu}\n",
+           BUILD_NAME, SCHED_POLICY, i2cReads, hostI2CFaults, i2cFailures,
+           i2cRecoveries, i2cSkippedReads, hostI2CBusClears, stale,
+           hostUartDrops, hostUartStalls, commands, hostTimerMisses);
+    fflush(stdout);
+    _exit(0);
+}
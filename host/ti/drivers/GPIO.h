@@ -0,0 +1,30 @@
+/*
+ *  ======== GPIO.h (host stand-in) ========
+ *  The subset of the TI GPIO driver API used by the applications.
+ */
+#ifndef ti_drivers_GPIO__include
+#define ti_drivers_GPIO__include
+
+#include <stdint.h>
+
+typedef uint32_t GPIO_PinConfig;
+typedef void (*GPIO_CallbackFxn)(uint_least8_t index);
+
+#define GPIO_CFG_OUT_STD        (0x0)
+#define GPIO_CFG_OUT_LOW        (0x0)
+#define GPIO_CFG_OUT_HIGH       (0x1)
+#define GPIO_CFG_IN_PU          (0x2)
+#define GPIO_CFG_IN_INT_FALLING (0x4)
+
+#define GPIO_STATUS_SUCCESS     (0)
+
+void GPIO_init(void);
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig);
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback);
+void GPIO_enableInt(uint_least8_t index);
+void GPIO_disableInt(uint_least8_t index);
+uint_fast8_t GPIO_read(uint_least8_t index);
+void GPIO_write(uint_least8_t index, unsigned int value);
+void GPIO_toggle(uint_least8_t index);
+
+#endif /* ti_drivers_GPIO__include */
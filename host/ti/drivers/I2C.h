@@ -0,0 +1,45 @@
+/*
+ *  ======== I2C.h (host stand-in) ========
+ *  The subset of the TI I2C driver API used by the applications.
+ */
+#ifndef ti_drivers_I2C__include
+#define ti_drivers_I2C__include
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct I2C_Config_ *I2C_Handle;
+
+typedef enum {
+    I2C_100kHz = 0,
+    I2C_400kHz = 1,
+    I2C_1000kHz = 2,
+    I2C_3400kHz = 3
+} I2C_BitRate;
+
+typedef struct {
+    I2C_BitRate bitRate;
+} I2C_Params;
+
+#define I2C_STATUS_SUCCESS      (0)
+#define I2C_STATUS_ERROR        (-1)
+#define I2C_STATUS_ADDR_NACK    (-5)
+#define I2C_STATUS_TIMEOUT      (-7)
+
+typedef struct {
+    void *writeBuf;
+    size_t writeCount;
+    void *readBuf;
+    size_t readCount;
+    uint_least8_t slaveAddress;
+    volatile int_fast16_t status;
+} I2C_Transaction;
+
+void I2C_init(void);
+void I2C_Params_init(I2C_Params *params);
+I2C_Handle I2C_open(uint_least8_t index, I2C_Params *params);
+void I2C_close(I2C_Handle handle);
+bool I2C_transfer(I2C_Handle handle, I2C_Transaction *transaction);
+
+#endif /* ti_drivers_I2C__include */
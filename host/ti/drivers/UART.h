@@ -0,0 +1,48 @@
+/*
+ *  ======== UART.h (host stand-in) ========
+ *  The subset of the TI UART driver API used by the applications.
+ */
+#ifndef ti_drivers_UART__include
+#define ti_drivers_UART__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct UART_Config_ *UART_Handle;
+typedef void (*UART_Callback)(UART_Handle handle, void *buf, size_t count);
+
+typedef enum {
+    UART_MODE_BLOCKING,
+    UART_MODE_CALLBACK
+} UART_Mode;
+
+typedef enum {
+    UART_DATA_BINARY = 0,
+    UART_DATA_TEXT = 1
+} UART_DataMode;
+
+typedef enum {
+    UART_RETURN_FULL,
+    UART_RETURN_NEWLINE
+} UART_ReturnMode;
+
+typedef struct {
+    UART_Mode readMode;
+    UART_Callback readCallback;
+    UART_DataMode writeDataMode;
+    UART_DataMode readDataMode;
+    UART_ReturnMode readReturnMode;
+    uint32_t baudRate;
+} UART_Params;
+
+#define UART_STATUS_ERROR   (-1)
+
+void UART_init(void);
+void UART_Params_init(UART_Params *params);
+UART_Handle UART_open(uint_least8_t index, UART_Params *params);
+void UART_close(UART_Handle handle);
+int_fast32_t UART_write(UART_Handle handle, const void *buffer, size_t size);
+int_fast32_t UART_writePolling(UART_Handle handle, const void *buffer, size_t size);
+int_fast32_t UART_read(UART_Handle handle, void *buffer, size_t size);
+
+#endif /* ti_drivers_UART__include */
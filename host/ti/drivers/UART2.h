@@ -0,0 +1,44 @@
+/*
+ *  ======== UART2.h (host stand-in) ========
+ *  The subset of the TI UART2 driver API used by the applications. Reads come
+ *  from the bytes queued with hostUart2Feed().
+ */
+#ifndef ti_drivers_UART2__include
+#define ti_drivers_UART2__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct UART2_Config_ *UART2_Handle;
+
+typedef enum {
+    UART2_Mode_BLOCKING,
+    UART2_Mode_CALLBACK,
+    UART2_Mode_NONBLOCKING
+} UART2_Mode;
+
+typedef enum {
+    UART2_ReadReturnMode_FULL,
+    UART2_ReadReturnMode_PARTIAL
+} UART2_ReadReturnMode;
+
+typedef struct {
+    UART2_Mode readMode;
+    UART2_Mode writeMode;
+    UART2_ReadReturnMode readReturnMode;
+    uint32_t baudRate;
+} UART2_Params;
+
+#define UART2_STATUS_SUCCESS    (0)
+#define UART2_STATUS_EFAIL      (-1)
+#define UART2_STATUS_EAGAIN     (-5)
+#define UART2_STATUS_ETIMEOUT   (-10)
+
+void UART2_Params_init(UART2_Params *params);
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params);
+void UART2_close(UART2_Handle handle);
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead);
+int_fast16_t UART2_readTimeout(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead, uint32_t timeout);
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size, size_t *bytesWritten);
+
+#endif /* ti_drivers_UART2__include */
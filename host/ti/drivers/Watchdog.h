@@ -0,0 +1,40 @@
+/*
+ *  ======== Watchdog.h (host stand-in) ========
+ *  The subset of the TI Watchdog driver API used by the applications. The
+ *  watchdog never runs out on its own; hostWatchdogExpire() fires its callback.
+ */
+#ifndef ti_drivers_Watchdog__include
+#define ti_drivers_Watchdog__include
+
+#include <stdint.h>
+
+#define Watchdog_STATUS_SUCCESS 0
+
+typedef struct Watchdog_Config_ *Watchdog_Handle;
+typedef void (*Watchdog_Callback)(uintptr_t handle);
+
+typedef enum {
+    Watchdog_DEBUG_STALL_ON,
+    Watchdog_DEBUG_STALL_OFF
+} Watchdog_DebugMode;
+
+typedef enum {
+    Watchdog_RESET_OFF,
+    Watchdog_RESET_ON
+} Watchdog_ResetMode;
+
+typedef struct {
+    Watchdog_Callback callbackFxn;
+    Watchdog_ResetMode resetMode;
+    Watchdog_DebugMode debugStallMode;
+} Watchdog_Params;
+
+void Watchdog_init(void);
+void Watchdog_Params_init(Watchdog_Params *params);
+Watchdog_Handle Watchdog_open(uint_least8_t index, Watchdog_Params *params);
+void Watchdog_clear(Watchdog_Handle handle);
+uint32_t Watchdog_convertMsToTicks(Watchdog_Handle handle, uint32_t milliseconds);
+int_fast16_t Watchdog_setReload(Watchdog_Handle handle, uint32_t ticks);
+void Watchdog_close(Watchdog_Handle handle);
+
+#endif /* ti_drivers_Watchdog__include */
@@ -0,0 +1,15 @@
+/*
+ *  ======== ClockP.h (host stand-in) ========
+ *  Only the system tick period, which the host counts as 1 ms.
+ */
+#ifndef ti_dpl_ClockP__include
+#define ti_dpl_ClockP__include
+
+#include <stdint.h>
+
+static inline uint32_t ClockP_getSystemTickPeriod(void)
+{
+    return 1000;
+}
+
+#endif /* ti_dpl_ClockP__include */
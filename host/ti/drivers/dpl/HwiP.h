@@ -0,0 +1,20 @@
+/*
+ *  ======== HwiP.h (host stand-in) ========
+ *  The host tools are single threaded, so there is nothing to mask.
+ */
+#ifndef ti_dpl_HwiP__include
+#define ti_dpl_HwiP__include
+
+#include <stdint.h>
+
+static inline uintptr_t HwiP_disable(void)
+{
+    return 0;
+}
+
+static inline void HwiP_restore(uintptr_t key)
+{
+    (void)key;
+}
+
+#endif /* ti_dpl_HwiP__include */
@@ -0,0 +1,36 @@
+/*
+ *  ======== simplelink.h (host stand-in) ========
+ *  The subset of the SimpleLink Wi-Fi host driver used by the applications:
+ *  starting the network processor and its file system. Files live in memory,
+ *  see host_drivers.h.
+ */
+#ifndef __SIMPLELINK_H__
+#define __SIMPLELINK_H__
+
+#include <stdint.h>
+
+typedef uint8_t _u8;
+typedef int8_t _i8;
+typedef uint16_t _u16;
+typedef int16_t _i16;
+typedef uint32_t _u32;
+typedef int32_t _i32;
+
+typedef void (*P_INIT_CALLBACK)(_u32 status, void *pDeviceInfo);
+
+#define SL_FS_READ                  ((_u32)0x0 << 12)
+#define SL_FS_WRITE                 ((_u32)0x1 << 12)
+#define SL_FS_CREATE                ((_u32)0x2 << 12)
+#define SL_FS_OVERWRITE             ((_u32)0x4 << 12)
+#define SL_FS_CREATE_FAILSAFE       ((_u32)0x1 << 20)
+#define SL_FS_CREATE_MAX_SIZE(size) ((_u32)(((size) + 3) / 4) & 0xFFF)  // In 4 byte blocks
+
+#define SL_ERROR_FS_FILE_NOT_EXISTS (-10341)
+
+_i16 sl_Start(const void *pIfHdl, _i8 *pDevName, const P_INIT_CALLBACK pInitCallBack);
+_i32 sl_FsOpen(const _u8 *pFileName, const _u32 AccessModeAndMaxSize, _u32 *pToken);
+_i32 sl_FsRead(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len);
+_i32 sl_FsWrite(const _i32 FileHdl, _u32 Offset, _u8 *pData, _u32 Len);
+_i16 sl_FsClose(const _i32 FileHdl, const _u8 *pCeritificateFileName, const _u8 *pSignature, const _u32 SignatureLen);
+
+#endif /* __SIMPLELINK_H__ */
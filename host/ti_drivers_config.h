@@ -0,0 +1,29 @@
+/*
+ *  ======== ti_drivers_config.h (host stand-in) ========
+ *  Mirrors the SysConfig output of both LaunchPad projects so their sources
+ *  build unchanged on the host.
+ */
+#ifndef ti_drivers_config_h
+#define ti_drivers_config_h
+
+#include <stdint.h>
+
+#define CONFIG_GPIO_BUTTON_0 13
+#define CONFIG_GPIO_BUTTON_1 22
+#define CONFIG_GPIO_LED_0 9
+
+#define CONFIG_GPIO_LED_ON  (1)
+#define CONFIG_GPIO_LED_OFF (0)
+
+#define CONFIG_LED_ON  (CONFIG_GPIO_LED_ON)
+#define CONFIG_LED_OFF (CONFIG_GPIO_LED_OFF)
+
+#define CONFIG_I2C_0    0
+#define CONFIG_TIMER_0  0
+#define CONFIG_UART_0   0
+#define CONFIG_UART2_0  0
+#define CONFIG_WATCHDOG_0 0
+
+extern void Board_init(void);
+
+#endif /* include guard */
@@ -0,0 +1,290 @@
+/*
+ *  ======== trace2json.c ========
+ *  Turns an event trace (common/trace.h) into Chrome trace JSON, which
+ *  chrome://tracing and ui.perfetto.dev show as a timeline.
+ *
+ *  The input is either a console capture holding the "@T,..." lines that
+ *  traceExport() prints, or with -b the memory of traceBuffer saved as a binary
+ *  file (from the debugger, or from soak -T). A capture with more than one dump
+ *  in it gives the last one.
+ *
+ *  Each task gets a track of its own with a slice per run, the I2C and UART
+ *  transfers get a track each, and interrupts show as instant events on a track
+ *  of their own. The 32 bit cycle stamps are unwrapped into microseconds from
+ *  the first record, so a trace may span any number of counter wraps as long as
+ *  no two records are more than one wrap apart. A reboot starts the count again
+ *  from zero; its marker is put a millisecond after the last record before it, and any
+ *  slice still open there (the task the watchdog caught, say) is closed at it.
+ *
+ *  Usage: trace2json [-b] file > trace.json
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#define HEADER_BYTES    16      // traceBuf up to ring[]
+#define MAX_TASKS       16
+
+// Track ids. Tasks use their TASK_Ids value.
+#define TID_I2C         20
+#define TID_UART        21
+#define TID_IRQ         22
+
+#define BOOT_GAP_US     1000.0
+
+static const char *const taskNames[] = { "SetTemp", "CheckUpBtn", "CheckDownBtn", "CheckTemp", "Output", "Stats" };
+static const char *const irqNames[] = { "timer", "button0", "button1", "uart rx", "watchdog" };
+
+static traceRecord *records;
+static size_t numRecords;
+static unsigned int cyclesPerUs;
+
+static double nowUs;
+static uint32_t lastTime;
+static bool started;
+static bool open[TID_IRQ + 1];
+static bool firstEvent = true;
+
+static void emit(const char *name, char phase, unsigned int tid, double ts, const char *args)
+{
+    printf("%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f%s%s%s%s}",
+           firstEvent ? "" : ",", name, phase, tid, ts,
+           (phase == 'i') ? ",\"s\":\"t\"" : "",
+           args ? ",\"args\":{" : "", args ? args : "", args ? "}" : "");
+    firstEvent = false;
+}
+
+static void threadName(unsigned int tid, const char *name)
+{
+    char args[64];
+
+    snprintf(args, sizeof(args), "\"name\":\"%s\"", name);
+    printf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{%s}}",
+           firstEvent ? "" : ",", tid, args);
+    firstEvent = false;
+}
+
+static void begin(const char *name, unsigned int tid, const char *args)
+{
+    emit(name, 'B', tid, nowUs, args);
+    open[tid] = true;
+}
+
+// A slice whose start is older than the ring is left out rather than drawn from zero
+static void end(const char *name, unsigned int tid, const char *args)
+{
+    if (open[tid]) {
+        emit(name, 'E', tid, nowUs, args);
+        open[tid] = false;
+    }
+}
+
+static void convert(void)
+{
+    char name[32];
+    char args[64];
+    const traceRecord *r;
+    unsigned int tid;
+    size_t i;
+
+    printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (tid = 0; tid < sizeof(taskNames) / sizeof(taskNames[0]); ++tid) {
+        threadName(tid, taskNames[tid]);
+    }
+    threadName(TID_I2C, "I2C");
+    threadName(TID_UART, "UART");
+    threadName(TID_IRQ, "interrupts");
+
+    for (i = 0; i < numRecords; ++i) {
+        r = &records[i];
+        if (r->type == TRACE_Boot) {
+            // Close whatever the reset cut short, then start the clock again
+            if (started) {
+                nowUs += BOOT_GAP_US;
+            }
+            for (tid = 0; tid <= TID_IRQ; ++tid) {
+                end("reset", tid, "\"cut\":1");
+            }
+            snprintf(args, sizeof(args), "\"boot\":%u", r->arg);
+            emit("boot", 'i', TID_IRQ, nowUs, args);
+            lastTime = r->time;
+            started = true;
+            continue;
+        }
+        if (started) {
+            nowUs += (double)(uint32_t)(r->time - lastTime) / cyclesPerUs;
+        }
+        lastTime = r->time;
+        started = true;
+
+        switch (r->type) {
+            case TRACE_TaskBegin:
+            case TRACE_TaskEnd:
+                if (r->id >= MAX_TASKS) {
+                    break;
+                }
+                if (r->id < sizeof(taskNames) / sizeof(taskNames[0])) {
+                    snprintf(name, sizeof(name), "%s", taskNames[r->id]);
+                } else {
+                    snprintf(name, sizeof(name), "task %u", r->id);
+                }
+                if (r->type == TRACE_TaskBegin) {
+                    begin(name, r->id, NULL);
+                } else {
+                    end(name, r->id, NULL);
+                }
+                break;
+            case TRACE_Isr:
+                if (r->id < sizeof(irqNames) / sizeof(irqNames[0])) {
+                    snprintf(name, sizeof(name), "%s", irqNames[r->id]);
+                } else {
+                    snprintf(name, sizeof(name), "irq %u", r->id);
+                }
+                snprintf(args, sizeof(args), "\"arg\":%u", r->arg);
+                emit(name, 'i', TID_IRQ, nowUs, args);
+                break;
+            case TRACE_I2CStart:
+                snprintf(name, sizeof(name), "i2c 0x%02x", r->id);
+                begin(name, TID_I2C, NULL);
+                break;
+            case TRACE_I2CEnd:
+                snprintf(name, sizeof(name), "i2c 0x%02x", r->id);
+                snprintf(args, sizeof(args), "\"ok\":%u", r->arg);
+                end(name, TID_I2C, args);
+                break;
+            case TRACE_UartStart:
+                snprintf(args, sizeof(args), "\"bytes\":%u", r->arg);
+                begin("uart write", TID_UART, args);
+                break;
+            case TRACE_UartEnd:
+                end("uart write", TID_UART, NULL);
+                break;
+            default:
+                break;
+        }
+    }
+    printf("\n]}\n");
+}
+
+// Keeps the records of the last "@T,begin" .. "@T,end" block
+static bool readText(FILE *in)
+{
+    char line[128];
+    const char *p;
+    unsigned long count;
+    unsigned int perUs;
+    unsigned long long value;
+    size_t capacity = 0;
+    bool inDump = false;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        p = strstr(line, "@T,");
+        if (p == NULL) {
+            continue;
+        }
+        if (sscanf(p, "@T,begin,%lu,%u", &count, &perUs) == 2) {
+            numRecords = 0;
+            cyclesPerUs = perUs;
+            inDump = true;
+            continue;
+        }
+        if (strncmp(p, "@T,end", 6) == 0) {
+            inDump = false;
+            continue;
+        }
+        if (!inDump || sscanf(p, "@T,%16llx", &value) != 1) {
+            continue;
+        }
+        if (numRecords == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            records = realloc(records, capacity * sizeof(*records));
+            if (records == NULL) {
+                return false;
+            }
+        }
+        records[numRecords].time = (uint32_t)(value >> 32);
+        records[numRecords].type = (uint8_t)(value >> 24);
+        records[numRecords].id = (uint8_t)(value >> 16);
+        records[numRecords].arg = (uint16_t)value;
+        ++numRecords;
+    }
+    return cyclesPerUs != 0;
+}
+
+// The image is little-endian, as the M4 stores it, and laid out as traceBuf
+static bool readBinary(FILE *in)
+{
+    uint8_t header[HEADER_BYTES];
+    traceRecord *ring;
+    uint32_t magic, count;
+    uint16_t size;
+    uint32_t first;
+    size_t i;
+
+    if (fread(header, sizeof(header), 1, in) != 1) {
+        return false;
+    }
+    magic = header[0] | header[1] << 8 | header[2] << 16 | (uint32_t)header[3] << 24;
+    count = header[4] | header[5] << 8 | header[6] << 16 | (uint32_t)header[7] << 24;
+    size = (uint16_t)(header[8] | header[9] << 8);
+    cyclesPerUs = header[10] | header[11] << 8;
+    if (magic != TRACE_MAGIC || size == 0 || (size & (size - 1)) != 0 || cyclesPerUs == 0) {
+        return false;
+    }
+
+    ring = malloc(size * sizeof(*ring));
+    records = malloc(size * sizeof(*records));
+    if (ring == NULL || records == NULL || fread(ring, sizeof(*ring), size, in) != size) {
+        return false;
+    }
+    numRecords = (count > size) ? size : count;
+    first = count - (uint32_t)numRecords;
+    for (i = 0; i < numRecords; ++i) {
+        records[i] = ring[(first + i) & (size - 1)];
+    }
+    free(ring);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    bool binary = false;
+    bool ok;
+    FILE *in;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b")) != -1) {
+        switch (opt) {
+            case 'b':
+                binary = true;
+                break;
+            default:
+                fprintf(stderr, "usage: trace2json [-b] file\n");
+                return 1;
+        }
+    }
+    if (optind + 1 != argc) {
+        fprintf(stderr, "usage: trace2json [-b] file\n");
+        return 1;
+    }
+
+    in = fopen(argv[optind], binary ? "rb" : "r");
+    if (in == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    ok = binary ? readBinary(in) : readText(in);
+    fclose(in);
+    if (!ok) {
+        fprintf(stderr, "trace2json: %s holds no trace\n", argv[optind]);
+        return 1;
+    }
+
+    convert();
+    return 0;
+}
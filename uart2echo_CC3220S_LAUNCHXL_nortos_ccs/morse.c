@@ -0,0 +1,179 @@
+/*
+ *  ======== morse.c ========
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "hal.h"
+#include "morse.h"
+#include "trace.h"
+
+// A code is packed into one byte: the number of symbols in the top 3 bits and
+// the symbols in the low 5, first symbol highest, 1 for a dash
+#define DOT  0
+#define DASH 1
+#define MORSE1(a)               ((1 << 5) | (a))
+#define MORSE2(a, b)            ((2 << 5) | ((a) << 1) | (b))
+#define MORSE3(a, b, c)         ((3 << 5) | ((a) << 2) | ((b) << 1) | (c))
+#define MORSE4(a, b, c, d)      ((4 << 5) | ((a) << 3) | ((b) << 2) | ((c) << 1) | (d))
+#define MORSE5(a, b, c, d, e)   ((5 << 5) | ((a) << 4) | ((b) << 3) | ((c) << 2) | ((d) << 1) | (e))
+
+// Indexed from '0'. Characters in between have no code and are skipped.
+static const uint8_t morseCodes['Z' - '0' + 1] = {
+    ['0' - '0'] = MORSE5(DASH, DASH, DASH, DASH, DASH),
+    ['1' - '0'] = MORSE5(DOT, DASH, DASH, DASH, DASH),
+    ['2' - '0'] = MORSE5(DOT, DOT, DASH, DASH, DASH),
+    ['3' - '0'] = MORSE5(DOT, DOT, DOT, DASH, DASH),
+    ['4' - '0'] = MORSE5(DOT, DOT, DOT, DOT, DASH),
+    ['5' - '0'] = MORSE5(DOT, DOT, DOT, DOT, DOT),
+    ['6' - '0'] = MORSE5(DASH, DOT, DOT, DOT, DOT),
+    ['7' - '0'] = MORSE5(DASH, DASH, DOT, DOT, DOT),
+    ['8' - '0'] = MORSE5(DASH, DASH, DASH, DOT, DOT),
+    ['9' - '0'] = MORSE5(DASH, DASH, DASH, DASH, DOT),
+    ['A' - '0'] = MORSE2(DOT, DASH),
+    ['B' - '0'] = MORSE4(DASH, DOT, DOT, DOT),
+    ['C' - '0'] = MORSE4(DASH, DOT, DASH, DOT),
+    ['D' - '0'] = MORSE3(DASH, DOT, DOT),
+    ['E' - '0'] = MORSE1(DOT),
+    ['F' - '0'] = MORSE4(DOT, DOT, DASH, DOT),
+    ['G' - '0'] = MORSE3(DASH, DASH, DOT),
+    ['H' - '0'] = MORSE4(DOT, DOT, DOT, DOT),
+    ['I' - '0'] = MORSE2(DOT, DOT),
+    ['J' - '0'] = MORSE4(DOT, DASH, DASH, DASH),
+    ['K' - '0'] = MORSE3(DASH, DOT, DASH),
+    ['L' - '0'] = MORSE4(DOT, DASH, DOT, DOT),
+    ['M' - '0'] = MORSE2(DASH, DASH),
+    ['N' - '0'] = MORSE2(DASH, DOT),
+    ['O' - '0'] = MORSE3(DASH, DASH, DASH),
+    ['P' - '0'] = MORSE4(DOT, DASH, DASH, DOT),
+    ['Q' - '0'] = MORSE4(DASH, DASH, DOT, DASH),
+    ['R' - '0'] = MORSE3(DOT, DASH, DOT),
+    ['S' - '0'] = MORSE3(DOT, DOT, DOT),
+    ['T' - '0'] = MORSE1(DASH),
+    ['U' - '0'] = MORSE3(DOT, DOT, DASH),
+    ['V' - '0'] = MORSE4(DOT, DOT, DOT, DASH),
+    ['W' - '0'] = MORSE3(DOT, DASH, DASH),
+    ['X' - '0'] = MORSE4(DASH, DOT, DOT, DASH),
+    ['Y' - '0'] = MORSE4(DASH, DOT, DASH, DASH),
+    ['Z' - '0'] = MORSE4(DASH, DASH, DOT, DOT),
+};
+
+// Both queues have one writer and one reader, so the indices need no locking.
+// Text: UART loop in, morsePump() out. Elements: morsePump() in, timer interrupt out.
+static char textQueue[MORSE_TEXT_QUEUE];
+static volatile uint16_t textHead, textTail;
+static uint8_t elementQueue[MORSE_ELEMENT_QUEUE];
+static volatile uint8_t elementHead, elementTail;
+
+unsigned long morseDropped = 0;
+
+static Timer_Handle morseTimer;
+static volatile bool playing = false;
+
+// Expands one character into elements. Returns how many, 0 if it has no code.
+uint8_t morseEncode(char c, uint8_t *elements)
+{
+    uint8_t code;
+    uint8_t len;
+    uint8_t n = 0;
+
+    if (c == ' ') {
+        // The letter before already ended with 3 units off
+        elements[n++] = 7 - 3;
+        return n;
+    }
+    if (c >= 'a' && c <= 'z') {
+        c -= 'a' - 'A';
+    }
+    if (c < '0' || c > 'Z' || morseCodes[c - '0'] == 0) {
+        return 0;
+    }
+
+    code = morseCodes[c - '0'];
+    for (len = code >> 5; len > 0; --len) {
+        elements[n++] = MORSE_ON | (((code >> (len - 1)) & 1) ? 3 : 1);
+        elements[n++] = (len > 1) ? 1 : 3;
+    }
+    return n;
+}
+
+// Starts the next element, or stops if there is none. Runs in the timer interrupt once playing.
+static void playNext(void)
+{
+    uint8_t e;
+
+    if (elementHead == elementTail) {
+        halPinWrite(CONFIG_GPIO_LED_0, false);
+        playing = false;
+        return;
+    }
+    e = elementQueue[elementHead % MORSE_ELEMENT_QUEUE];
+    ++elementHead;
+
+    halPinWrite(CONFIG_GPIO_LED_0, (e & MORSE_ON) != 0);
+    halTimerSetPeriod(morseTimer, (uint32_t)MORSE_UNITS(e) * MORSE_UNIT_MS * 1000);
+    halTimerStart(morseTimer);
+}
+
+static void morseTimerCallback(Timer_Handle handle, int_fast16_t status)
+{
+    traceEvent(TRACE_Isr, TRACE_IrqTimer, 0);
+    playNext();
+}
+
+void morseInit(void)
+{
+    morseTimer = halTimerOpen(CONFIG_TIMER_0, MORSE_UNIT_MS * 1000, Timer_ONESHOT_CALLBACK, morseTimerCallback);
+    if (morseTimer == NULL) {
+        /* Failed to initialized timer */
+        while (1) {}
+    }
+}
+
+// Queues as much of the text as fits and drops the rest, counting it in morseDropped.
+// Returns how many characters were taken.
+size_t morseQueueText(const char *text, size_t len)
+{
+    size_t n = 0;
+
+    while (n < len && (uint16_t)(textTail - textHead) < MORSE_TEXT_QUEUE) {
+        textQueue[textTail % MORSE_TEXT_QUEUE] = text[n++];
+        ++textTail;
+    }
+    morseDropped += len - n;
+    return n;
+}
+
+// Expands queued text while the element queue has room, and starts playback. Call from the main loop.
+void morsePump(void)
+{
+    uint8_t elements[MORSE_MAX_ELEMENTS];
+    uint8_t n;
+    uint8_t i;
+
+    while (textHead != textTail
+           && (uint8_t)(elementTail - elementHead) <= MORSE_ELEMENT_QUEUE - MORSE_MAX_ELEMENTS) {
+        n = morseEncode(textQueue[textHead % MORSE_TEXT_QUEUE], elements);
+        ++textHead;
+        for (i = 0; i < n; ++i) {
+            elementQueue[elementTail % MORSE_ELEMENT_QUEUE] = elements[i];
+            ++elementTail;
+        }
+    }
+
+    // The timer is stopped while nothing plays, so the interrupt can't race this
+    if (!playing && elementHead != elementTail) {
+        playing = true;
+        playNext();
+    }
+}
+
+// True while text is queued or playing
+bool morseBusy(void)
+{
+    return playing || textHead != textTail || elementHead != elementTail;
+}
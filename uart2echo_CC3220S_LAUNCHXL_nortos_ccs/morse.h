@@ -0,0 +1,36 @@
+/*
+ *  ======== morse.h ========
+ *  Keys text on CONFIG_GPIO_LED_0 in Morse code.
+ *
+ *  Text goes into a queue and is expanded into LED on/off elements, each a
+ *  number of Morse units long: a dot is 1 unit on, a dash 3, the gap inside a
+ *  letter 1 unit off, between letters 3 and between words 7. A one-shot timer
+ *  plays the elements back, reloading itself with the length of the next one,
+ *  so the LED changes without the main loop doing anything in between.
+ */
+#ifndef MORSE_H_
+#define MORSE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MORSE_UNIT_MS       100     // 12 words per minute
+
+#define MORSE_TEXT_QUEUE    256     // Characters waiting to be expanded, power of 2
+#define MORSE_ELEMENT_QUEUE 64      // Expanded elements waiting to play, power of 2
+#define MORSE_MAX_ELEMENTS  11      // Most elements one character expands to
+
+// An element is the LED level in the top bit and its length in units below it
+#define MORSE_ON            0x80
+#define MORSE_UNITS(e)      ((e) & 0x7F)
+
+extern unsigned long morseDropped;      // Characters that found the text queue full
+
+void morseInit(void);
+size_t morseQueueText(const char *text, size_t len);
+void morsePump(void);
+bool morseBusy(void);
+uint8_t morseEncode(char c, uint8_t *elements);
+
+#endif /* MORSE_H_ */
@@ -37,12 +37,18 @@
 #include <stddef.h>
 
 /* Driver Header files */
-#include <ti/drivers/GPIO.h>
 #include <ti/drivers/UART2.h>
 
 /* Driver configuration */
 #include "ti_drivers_config.h"
 
+#include "cycles.h"
+#include "hal.h"
+#include "morse.h"
+#include "trace.h"
+
+#define ECHO_CHUNK 32
+
 // Shared variables to track entered key stroke and LED status
 volatile char input;
 volatile char ledOn;  // bit
@@ -75,13 +81,16 @@ void TickFunction_SetLED() {
             break;
     }
 
-    // Handle the activities for each state
+    // Handle the activities for each state. The Morse engine owns the LED while it plays.
+    if (morseBusy()) {
+        return;
+    }
     switch (LED_State) {
         case LED_ON:
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
+            halPinWrite(CONFIG_GPIO_LED_0, true);
             break;
         case LED_OFF:
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
+            halPinWrite(CONFIG_GPIO_LED_0, false);
             break;
         default:
             break;
@@ -164,23 +173,24 @@ void TickFunction_TrackEntry() {
 void* mainThread(void *arg0)
 {
     UART2_Handle uart;
-    UART2_Params uartParams;
     size_t bytesRead;
     size_t bytesWritten = 0;
-    uint32_t status = UART2_STATUS_SUCCESS;
-    char input_local;
+    int_fast16_t status = UART2_STATUS_SUCCESS;
+    char buffer[ECHO_CHUNK];
+    size_t i;
+    char keying = 0;
 
     /* Call driver init functions */
-    GPIO_init();
+    halGpioInit();
+    cyclesInit();
+    traceInit();
 
     /* Configure the LED pin */
-    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
-
-    /* Create a UART where the default read and write mode is BLOCKING */
-    UART2_Params_init(&uartParams);
-    uartParams.baudRate = 115200;
+    halOutputInit(CONFIG_GPIO_LED_0);
 
-    uart = UART2_open(CONFIG_UART2_0, &uartParams);
+    /* Create a UART with blocking reads and writes. A read returns as soon as
+     * anything has come in, or after a Morse unit with nothing. */
+    uart = halUart2Open(CONFIG_UART2_0, UART2_Mode_BLOCKING);
 
     if (uart == NULL)
     {
@@ -189,32 +199,49 @@ void* mainThread(void *arg0)
             ;
     }
 
+    morseInit();
+
     /* Turn on user LED to indicate successful initialization */
-    GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
+    halPinWrite(CONFIG_GPIO_LED_0, true);
 
-    /* Loop forever echoing */
+    /* Loop forever echoing. Everything typed is also keyed in Morse. */
     while (1)
     {
-        status = UART2_read(uart, &input_local, 1, &bytesRead);
+        // Waits in the driver for input, but no longer than a Morse unit so playback
+        // is still fed while nothing is typed
+        status = halUart2ReadTimeout(uart, buffer, ECHO_CHUNK, &bytesRead, MORSE_UNIT_MS);
 
-        if (status != UART2_STATUS_SUCCESS)
+        if (status != UART2_STATUS_SUCCESS && status != UART2_STATUS_ETIMEOUT)
         {
             /* UART2_read() failed */
             while (1);
-        } else {
-            input = input_local;
         }
 
-        status = UART2_write(uart, &input_local, 1, &bytesWritten);
+        if (bytesRead > 0) {
+            status = halUart2Write(uart, buffer, bytesRead, &bytesWritten);
 
-        if (status != UART2_STATUS_SUCCESS)
-        {
-            /* UART2_write() failed */
-            while (1);
+            if (status != UART2_STATUS_SUCCESS)
+            {
+                /* UART2_write() failed */
+                while (1);
+            }
+
+            // Everything is echoed. Whatever the Morse queue can't hold isn't keyed and
+            // is counted in morseDropped.
+            morseQueueText(buffer, bytesRead);
+            for (i = 0; i < bytesRead; ++i) {
+                input = buffer[i];
+                TickFunction_TrackEntry();
+                TickFunction_SetLED();
+            }
         }
 
-        TickFunction_TrackEntry();
-        TickFunction_SetLED();
+        morsePump();
 
+        // Hand the LED back to the ON/OFF state machine once the message is done
+        if (keying && !morseBusy()) {
+            TickFunction_SetLED();
+        }
+        keying = morseBusy();
     }
 }